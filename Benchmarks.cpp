@@ -0,0 +1,1412 @@
+#include "GameRecord.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iomanip>
+#include <iterator>
+#include <random>
+#include <sstream>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// =============================
+// Benchmarks (nba_db --bench <name> [data file])
+// =============================
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+
+    double elapsedMs(bench_clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(bench_clock::now() - t0).count();
+    }
+
+    // Best of `reps` runs, in milliseconds
+    template <typename Fn>
+    double bestOf(int reps, Fn fn)
+    {
+        double best = 0.0;
+        for (int i = 0; i < reps; i++)
+        {
+            auto t0 = bench_clock::now();
+            fn();
+            double ms = elapsedMs(t0);
+            if (i == 0 || ms < best)
+                best = ms;
+        }
+        return best;
+    }
+
+    bool readWholeFile(const std::string &path, std::string &out)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+        {
+            std::cerr << "Error: Cannot open file " << path << std::endl;
+            return false;
+        }
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        out = ss.str();
+        return true;
+    }
+
+    // Header line once, then the data lines repeated `scale` times
+    std::string scaleUp(const std::string &text, int scale)
+    {
+        size_t nl = text.find('\n');
+        if (nl == std::string::npos)
+            return text;
+        std::string body = text.substr(nl + 1);
+        if (!body.empty() && body.back() != '\n')
+            body += '\n';
+        std::string out = text.substr(0, nl + 1);
+        out.reserve(out.size() + body.size() * scale);
+        for (int i = 0; i < scale; i++)
+            out += body;
+        return out;
+    }
+
+    // data_file loaded once, then every record appended `scale` times in total
+    bool loadScaled(DatabaseFile &db, const std::string &data_file, int scale)
+    {
+        DatabaseFile src("bench_source.db");
+        if (!src.loadFromTextFile(data_file))
+            return false;
+        for (int i = 0; i < scale; i++)
+            for (size_t b = 0; b < src.getTotalBlocks(); b++)
+            {
+                BlockRef blk = src.getBlock(b);
+                for (int r = 0; r < blk->record_count; r++)
+                    db.addRecord(blk->getRecord(r));
+            }
+        return true;
+    }
+
+    // Size of the file at path in bytes (0 if it cannot be opened)
+    size_t fileBytes(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        return in.is_open() ? (size_t)in.tellg() : 0;
+    }
+
+    // Field-by-field, so padding bytes do not count
+    bool sameRecord(const GameRecord &a, const GameRecord &b)
+    {
+        const char *pa = reinterpret_cast<const char *>(&a);
+        const char *pb = reinterpret_cast<const char *>(&b);
+        for (int c = 0; c < GAME_COLUMN_COUNT; c++)
+        {
+            const size_t offset = Block::columnRecordOffset((GameColumn)c);
+            if (std::memcmp(pa + offset, pb + offset, Block::columnWidth((GameColumn)c)) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Resident set size of this process in bytes (0 where /proc is unavailable)
+    size_t residentBytes()
+    {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        size_t total = 0, resident = 0;
+        if (statm >> total >> resident)
+            return resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+        return 0;
+    }
+
+    void printRow(const std::string &name, double ms, size_t bytes, size_t count,
+                  const char *unit = "records")
+    {
+        std::cout << "  " << std::left << std::setw(28) << name << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(10) << ms << " ms"
+                  << std::setw(10) << std::setprecision(0) << (bytes / 1048576.0) / (ms / 1000.0) << " MB/s"
+                  << std::setw(12) << count << " " << unit << std::endl;
+    }
+
+    // One node-search micro-benchmark: `nodes` ascending nodes of `fanout`
+    // distinct column values, probed with values drawn from the same column
+    template <typename K>
+    struct NodeSearchBench
+    {
+        int fanout = 0;
+        std::vector<K> keys; // node i is keys[i * fanout, (i + 1) * fanout)
+        std::vector<std::pair<int, K>> probes;
+        long long expected = -1;
+
+        NodeSearchBench(const std::vector<K> &column, int max_fanout, int nodes, int probe_count, std::mt19937 &rng)
+        {
+            std::vector<K> distinct(column);
+            std::sort(distinct.begin(), distinct.end());
+            distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+            fanout = std::min<int>(max_fanout, (int)distinct.size());
+            for (int n = 0; n < nodes; n++)
+            {
+                std::shuffle(distinct.begin(), distinct.end(), rng);
+                std::vector<K> node(distinct.begin(), distinct.begin() + fanout);
+                std::sort(node.begin(), node.end());
+                keys.insert(keys.end(), node.begin(), node.end());
+            }
+            for (int i = 0; i < probe_count; i++)
+                probes.push_back({(int)(rng() % nodes), column[rng() % column.size()]});
+        }
+
+        // Times search(node keys, fanout, probe) -> child index over every probe
+        template <typename Fn>
+        void row(const std::string &name, Fn search)
+        {
+            long long sum = 0;
+            const double ms = bestOf(5, [&]()
+                                     {
+                                         sum = 0;
+                                         for (const auto &p : probes)
+                                             sum += search(keys.data() + (size_t)p.first * fanout, fanout, p.second);
+                                     });
+            if (expected < 0)
+                expected = sum;
+            std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(10) << ms * 1e6 / probes.size() << " ns/search"
+                      << (sum == expected ? "" : "   MISMATCH") << std::endl;
+        }
+    };
+
+    // One fanout of one index: shape, node memory, bulk/insert build times and
+    // point-lookup latency over `probes` (existing and absent keys)
+    template <typename K, int F>
+    void fanoutRow(IndexManager &im, const std::vector<IndexEntry<K>> &entries, const std::vector<K> &probes,
+                   long long &expected)
+    {
+        BPlusTree<K, F> root;
+        const double bulk_ms = bestOf(3, [&]() { root = im.buildTree<K, F>(entries, true); });
+        BPlusTree<K, F> inserted;
+        const double insert_ms = bestOf(1, [&]() { inserted = im.buildTree<K, F>(entries, false); });
+
+        long long sum = 0;
+        const double lookup_ms = bestOf(5, [&]()
+                                        {
+                                            sum = 0;
+                                            for (const K &key : probes)
+                                            {
+                                                const PostingList *pl = im.findKey(root, key);
+                                                sum += pl ? pl->count : -1;
+                                            }
+                                        });
+        if (expected < 0)
+            expected = sum;
+
+        int height = 0, nodes = 0, insert_height = 0, insert_nodes = 0;
+        im.treeShape(root, height, nodes);
+        im.treeShape(inserted, insert_height, insert_nodes);
+        std::cout << "  " << std::setw(6) << F << (F == IndexFanout<K>::value ? "*" : " ") << std::setw(8)
+                  << sizeof(typename BPlusTree<K, F>::Leaf) << std::setw(8) << height << std::setw(9) << nodes
+                  << std::fixed << std::setprecision(2) << std::setw(10) << root.nodeBytes() / 1048576.0 << std::setw(10)
+                  << bulk_ms << std::setw(10) << insert_ms << std::setw(5) << insert_height << std::setw(9)
+                  << insert_nodes << std::setprecision(1) << std::setw(12) << lookup_ms * 1e6 / probes.size()
+                  << (sum == expected ? "" : "   MISMATCH") << std::endl;
+    }
+
+    template <typename K>
+    void fanoutSweep(const char *name, const std::vector<IndexEntry<K>> &entries, const std::vector<K> &absent,
+                     std::mt19937 &rng)
+    {
+        std::vector<K> probes;
+        for (int i = 0; i < (1 << 17); i++)
+            probes.push_back(i % 8 == 0 ? absent[rng() % absent.size()] : entries[rng() % entries.size()].key);
+
+        std::cout << "\n=== Fanout sweep: " << name << " (" << entries.size() << " entries, " << probes.size()
+                  << " point lookups, * = page-sized default) ===" << std::endl;
+        std::cout << "  " << std::setw(7) << "fanout" << std::setw(8) << "leaf B" << std::setw(8) << "height"
+                  << std::setw(9) << "nodes" << std::setw(10) << "node MB" << std::setw(10) << "bulk ms"
+                  << std::setw(10) << "insert ms" << std::setw(5) << "ht" << std::setw(9) << "nodes"
+                  << std::setw(12) << "lookup ns" << std::endl;
+        IndexManager im;
+        long long expected = -1;
+        fanoutRow<K, 8>(im, entries, probes, expected);
+        fanoutRow<K, 16>(im, entries, probes, expected);
+        fanoutRow<K, IndexFanout<K>::value>(im, entries, probes, expected);
+        fanoutRow<K, 32>(im, entries, probes, expected);
+        fanoutRow<K, 64>(im, entries, probes, expected);
+        fanoutRow<K, 128>(im, entries, probes, expected);
+        fanoutRow<K, 256>(im, entries, probes, expected);
+    }
+
+    template <typename K>
+    void nodeSearchSimdRows(NodeSearchBench<K> &bench)
+    {
+        for (Simd::Level level : {Simd::Level::Scalar, Simd::Level::SSE2, Simd::Level::AVX2})
+        {
+            if (Simd::detectLevel() < level)
+                break;
+            bench.row(std::string("compare-and-count ") + Simd::levelName(level),
+                      [level](const K *k, int n, const K &key) { return Simd::countLessEqual(k, n, key, level); });
+        }
+    }
+
+    // No SIMD kernels for 16-bit keys: the tree searches them with KeySearch
+    void nodeSearchSimdRows(NodeSearchBench<DayCode> &)
+    {
+    }
+
+    template <typename K>
+    void nodeSearchRun(const char *type, const std::vector<K> &column, int max_fanout, std::mt19937 &rng)
+    {
+        NodeSearchBench<K> bench(column, max_fanout, 1024, 1 << 18, rng);
+        std::cout << "\n=== Node search: " << type << " keys, fanout " << bench.fanout << ", 1024 nodes, "
+                  << bench.probes.size() << " probes (best of 5) ===" << std::endl;
+        bench.row("linear (original)", [](const K *k, int n, const K &key)
+                  { return KeySearch<K>::linearUpperBound(k, n, key); });
+        bench.row("std::upper_bound", [](const K *k, int n, const K &key)
+                  { return (int)(std::upper_bound(k, k + n, key) - k); });
+        bench.row("branchless binary", [](const K *k, int n, const K &key)
+                  { return KeySearch<K>::binaryUpperBound(k, n, key); });
+        nodeSearchSimdRows(bench);
+        bench.row("KeySearch (used by the tree)", [](const K *k, int n, const K &key)
+                  { return KeySearch<K>::upperBound(k, n, key); });
+    }
+}
+
+namespace Bench
+{
+    // getline + Utils::split (parseGameLine) against the SIMD delimiter scan
+    // (parseLines) at every level, single-threaded on games.txt scaled up
+    void tokenizer(const std::string &data_file, int scale)
+    {
+        std::string raw;
+        if (!readWholeFile(data_file, raw))
+            return;
+        const std::string text = scaleUp(raw, scale);
+        const char *body = text.data() + text.find('\n') + 1;
+        const char *end = text.data() + text.size();
+        const size_t bytes = (size_t)(end - body);
+
+        std::cout << "\n=== Tokenizer benchmark: " << data_file << " x" << scale << " ("
+                  << std::fixed << std::setprecision(1) << bytes / 1048576.0 << " MB, best of 3, 1 thread) ===" << std::endl;
+        std::cout << "CPU SIMD level: " << Simd::levelName(Simd::detectLevel()) << std::endl;
+
+        DatabaseFile db("bench_tokenizer.db");
+        size_t records = 0;
+
+        double ms = bestOf(3, [&]()
+        {
+            records = 0;
+            std::istringstream in(std::string(body, end));
+            std::string line;
+            while (std::getline(in, line))
+            {
+                GameRecord record;
+                if (db.parseGameLine(line, record) && db.isRecordValid(record))
+                    records++;
+            }
+        });
+        printRow("getline + Utils::split", ms, bytes, records);
+
+        const Simd::Level levels[] = {Simd::Level::Scalar, Simd::Level::SSE2, Simd::Level::AVX2};
+        std::vector<uint32_t> delims(bytes);
+        for (Simd::Level level : levels)
+        {
+            if (level > Simd::detectLevel())
+                continue;
+
+            ms = bestOf(3, [&]() { records = Simd::findDelimiters(body, bytes, delims.data(), level); });
+            printRow(std::string("scan only, ") + Simd::levelName(level), ms, bytes, records, "delimiters");
+
+            std::vector<GameRecord> out;
+            out.reserve(bytes / 40);
+            ms = bestOf(3, [&]()
+            {
+                out.clear();
+                int skipped = 0;
+                std::string warnings;
+                db.parseLines(body, end, out, skipped, warnings, level);
+            });
+            printRow(std::string("parseLines, ") + Simd::levelName(level), ms, bytes, out.size());
+        }
+    }
+
+    // pts_home BETWEEN 100 AND 120 AND fg3_pct_home > 0.4 over every block:
+    // record-at-a-time getRecord() loop against the block-at-a-time predicate
+    // kernels, for row and PAX blocks
+    void scan(const std::string &data_file, int scale)
+    {
+        const std::vector<ScanPredicate> preds = {
+            ScanPredicate::between(GameColumn::Points, 100, 120),
+            ScanPredicate::greaterThan(GameColumn::Fg3Pct, 0.4)};
+
+        const BlockLayout layouts[] = {BlockLayout::Row, BlockLayout::Pax};
+        for (BlockLayout layout : layouts)
+        {
+            DatabaseFile db("bench_scan.db");
+            db.setBlockLayout(layout);
+            if (!loadScaled(db, data_file, scale))
+                return;
+            const size_t bytes = db.getTotalBlocks() * Block::BLOCK_SIZE;
+
+            std::cout << "\n=== Scan benchmark (" << (layout == BlockLayout::Pax ? "PAX" : "row")
+                      << " blocks): " << data_file << " x" << scale << ", " << db.getTotalRecords()
+                      << " records, best of 5 ===" << std::endl;
+
+            size_t matches = 0;
+            double ms = bestOf(5, [&]()
+            {
+                matches = 0;
+                for (size_t b = 0; b < db.getTotalBlocks(); b++)
+                {
+                    BlockRef blk = db.getBlock(b);
+                    for (int r = 0; r < blk->record_count; r++)
+                    {
+                        GameRecord rec = blk->getRecord(r);
+                        if (rec.pts_home >= 100 && rec.pts_home <= 120 && rec.fg3_pct_home > 0.4f)
+                            matches++;
+                    }
+                }
+            });
+            printRow("getRecord loop", ms, bytes, matches);
+
+            const Simd::Level levels[] = {Simd::Level::Scalar, Simd::Level::SSE2, Simd::Level::AVX2};
+            for (Simd::Level level : levels)
+            {
+                if (level > Simd::detectLevel())
+                    continue;
+                ms = bestOf(5, [&]() { matches = db.scan(preds, level).size(); });
+                printRow(std::string("scan(), ") + Simd::levelName(level), ms, bytes, matches);
+            }
+        }
+    }
+
+    // Full scans with zone maps off and on: a date range (benefits from the
+    // file being grouped by season), a selective and an unselective predicate
+    void zoneMaps(const std::string &data_file, int scale)
+    {
+        DatabaseFile db("bench_zonemap.db");
+        if (!loadScaled(db, data_file, scale))
+            return;
+
+        std::cout << "\n=== Zone map benchmark: " << data_file << " x" << scale << ", "
+                  << db.getTotalRecords() << " records in " << db.getTotalBlocks()
+                  << " blocks, best of 5 ===" << std::endl;
+
+        const std::pair<const char *, std::vector<ScanPredicate>> queries[] = {
+            {"2014-15 season", {ScanPredicate::between(GameColumn::Date, 20141001, 20150630)}},
+            {"points >= 150", {ScanPredicate::atLeast(GameColumn::Points, 150)}},
+            {"FT% > 0.9", {ScanPredicate::greaterThan(GameColumn::FtPct, 0.9)}}};
+        for (const auto &q : queries)
+        {
+            size_t matches = 0, blocks_read = 0;
+            for (bool enabled : {false, true})
+            {
+                db.setZoneMapsEnabled(enabled);
+                double ms = bestOf(5, [&]() { matches = db.scan(q.second, Simd::detectLevel(), &blocks_read).size(); });
+                printRow(std::string(q.first) + (enabled ? ", zone maps" : ", all blocks"), ms,
+                         blocks_read * Block::BLOCK_SIZE, blocks_read, "blocks read");
+            }
+            std::cout << "  (" << matches << " matching records)" << std::endl;
+        }
+    }
+
+    // Thread-count sweep of the block-partitioned passes: a full scan and the
+    // linear FT% deletion (zone maps off so every block is work), speedup
+    // relative to one thread
+    void threads(const std::string &data_file, int scale)
+    {
+        DatabaseFile db("bench_threads.db");
+        if (!loadScaled(db, data_file, scale))
+            return;
+        db.setZoneMapsEnabled(false);
+        const size_t bytes = db.getTotalBlocks() * Block::BLOCK_SIZE;
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+        std::cout << "\n=== Thread sweep: " << data_file << " x" << scale << ", " << db.getTotalBlocks()
+                  << " blocks, " << hw << " hardware threads, best of 5 ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(9) << "threads" << std::right
+                  << std::setw(12) << "scan ms" << std::setw(10) << "speedup"
+                  << std::setw(14) << "delete ms" << std::setw(10) << "speedup"
+                  << std::setw(10) << "steals" << std::endl;
+
+        std::vector<unsigned> counts;
+        for (unsigned t = 1; t <= std::max(4u, hw); t *= 2)
+            counts.push_back(t);
+        if (hw > counts.back())
+            counts.push_back(hw);
+
+        const std::vector<ScanPredicate> preds = {
+            ScanPredicate::between(GameColumn::Points, 100, 120),
+            ScanPredicate::greaterThan(GameColumn::Fg3Pct, 0.4)};
+        double scan_base = 0.0, delete_base = 0.0;
+        size_t matches = 0;
+        uint32_t deleted = 0;
+        for (unsigned t : counts)
+        {
+            db.setScanThreads(t);
+            const double scan_ms = bestOf(5, [&]() { matches = db.scan(preds).size(); });
+            const double delete_ms = bestOf(5, [&]()
+            {
+                db.clearDeleted();
+                deleted = db.deleteByFTAboveLinear(0.9f).nDeleted;
+            });
+            db.clearDeleted();
+            if (t == 1)
+            {
+                scan_base = scan_ms;
+                delete_base = delete_ms;
+            }
+            std::cout << "  " << std::left << std::setw(9) << t << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << scan_ms << std::setw(9) << scan_base / scan_ms << "x"
+                      << std::setw(14) << delete_ms << std::setw(9) << delete_base / delete_ms << "x"
+                      << std::setw(10) << db.getScanSteals() << std::endl;
+        }
+        std::cout << "  (" << matches << " scan matches, " << deleted << " deletions per run, "
+                  << std::setprecision(0) << (bytes / 1048576.0) << " MB per pass)" << std::endl;
+    }
+
+    // Randomized differential check of the index lookups against a plain
+    // getRecord() loop, for bulk-loaded trees (full and random fill factor)
+    // and insert-built trees, before and while every row is deleted again
+    // through the indexes, followed by equality, date-range and team + date
+    // lookups timed against a vectorized full scan and an index-only
+    // aggregate timed against fetching every match. Returns false on any mismatch.
+    bool indexes(const std::string &data_file, int scale, int queries)
+    {
+        typedef std::vector<std::pair<int, int>> Rids;
+        DatabaseFile db("bench_index.db");
+        if (!loadScaled(db, data_file, scale))
+            return false;
+
+        std::vector<std::pair<std::pair<int, int>, GameRecord>> rows;
+        rows.reserve(db.getTotalRecords());
+        for (size_t b = 0; b < db.getTotalBlocks(); b++)
+        {
+            BlockRef blk = db.getBlock(b);
+            for (int r = 0; r < blk->record_count; r++)
+                rows.push_back({{(int)b, r}, blk->getRecord(r)});
+        }
+        auto sorted = [](Rids v)
+        {
+            std::sort(v.begin(), v.end());
+            return v;
+        };
+
+        const unsigned seed = 20260101u;
+        std::mt19937 rng(seed);
+        auto pick = [&]() -> const GameRecord & { return rows[rng() % rows.size()].second; };
+        auto coin = [&](int one_in) { return rng() % one_in == 0; };
+
+        std::cout << "\n=== Index differential check: " << data_file << " x" << scale << ", "
+                  << db.getTotalRecords() << " records, " << queries << " random queries per build, seed "
+                  << seed << " ===" << std::endl;
+
+        // Random queries of every kind against the live rows; counts mismatches
+        std::vector<uint8_t> alive(rows.size(), 1);
+        size_t returned = 0;
+        auto runQueries = [&](IndexManager &im, int count)
+        {
+            auto truth = [&](const std::function<bool(const GameRecord &)> &match)
+            {
+                Rids out;
+                for (size_t i = 0; i < rows.size(); i++)
+                    if (alive[i] && match(rows[i].second))
+                        out.push_back(rows[i].first);
+                return out;
+            };
+            size_t wrong = 0;
+            for (int q = 0; q < count; q++)
+            {
+                Rids got, want;
+                switch (rng() % 7)
+                {
+                case 0:
+                {
+                    const int team = coin(10) ? 42 : pick().team_id_home;
+                    got = im.searchByTeamId(team);
+                    want = truth([&](const GameRecord &g) { return g.team_id_home == team; });
+                    break;
+                }
+                case 1:
+                {
+                    const int lo = 50 + (int)(rng() % 120), hi = coin(3) ? lo : lo + (int)(rng() % 25);
+                    got = im.searchByPointsRange(lo, hi);
+                    want = truth([&](const GameRecord &g) { return g.pts_home >= lo && g.pts_home <= hi; });
+                    break;
+                }
+                case 2:
+                {
+                    const float lo = pick().fg_pct_home, hi = coin(3) ? lo : lo + (rng() % 50) / 1000.0f;
+                    got = im.searchByFGPercentage(lo, hi);
+                    want = truth([&](const GameRecord &g) { return g.fg_pct_home >= lo && g.fg_pct_home <= hi; });
+                    break;
+                }
+                case 3:
+                {
+                    const float lo = pick().ft_pct_home, hi = coin(3) ? lo : lo + (rng() % 100) / 1000.0f;
+                    got = im.searchByFTPercentage(lo, hi);
+                    want = truth([&](const GameRecord &g) { return g.ft_pct_home >= lo && g.ft_pct_home <= hi; });
+                    break;
+                }
+                case 4:
+                {
+                    // One team's games in a date range, or all of them (prefix)
+                    const int team = coin(10) ? 42 : pick().team_id_home;
+                    const int first = pick().game_date, last = first + (int)(rng() % 20000);
+                    const bool prefix = coin(4);
+                    got = prefix ? im.searchByTeamInDateOrder(team) : im.searchByTeamAndDateRange(team, first, last);
+                    want = truth([&](const GameRecord &g)
+                                 { return g.team_id_home == team && (prefix || (g.game_date >= first && g.game_date <= last)); });
+                    break;
+                }
+                case 5:
+                {
+                    // Index-only FT% aggregate against the same sums over the rows
+                    const float lo = pick().ft_pct_home, hi = coin(3) ? lo : lo + (rng() % 100) / 1000.0f;
+                    const CoveredStats agg = im.aggregateByFTPercentage(lo, hi);
+                    CoveredStats expect;
+                    for (size_t i = 0; i < rows.size(); i++)
+                    {
+                        const GameRecord &g = rows[i].second;
+                        if (!alive[i] || g.ft_pct_home < lo || g.ft_pct_home > hi)
+                            continue;
+                        expect.rows++;
+                        expect.sumPts += g.pts_home;
+                        expect.wins += g.home_team_wins ? 1 : 0;
+                    }
+                    returned += agg.rows;
+                    if (agg.rows != expect.rows || agg.sumPts != expect.sumPts || agg.wins != expect.wins)
+                        wrong++;
+                    continue;
+                }
+                default:
+                {
+                    // Text equality through the parser, or a YYYYMMDD key range
+                    const int first = coin(10) ? 20150231 : pick().game_date;
+                    const int last = coin(2) ? first : first + (int)(rng() % 400);
+                    got = first == last ? im.searchByDate(Utils::formatDateKey(first))
+                                        : im.searchByDateRange(first, last);
+                    want = truth([&](const GameRecord &g) { return g.game_date >= first && g.game_date <= last; });
+                    break;
+                }
+                }
+                returned += got.size();
+                if (sorted(got) != want)
+                    wrong++;
+            }
+            return wrong;
+        };
+
+        size_t mismatches = 0;
+        for (int build = 0; build < 3; build++)
+        {
+            const bool bulk = build < 2;
+            const float fill = build == 1 ? 0.5f + (rng() % 51) / 100.0f : 1.0f;
+            IndexManager im;
+            im.buildIndexes(db, bulk, fill);
+
+            returned = 0;
+            mismatches += runQueries(im, queries);
+            std::cout << "  " << (bulk ? "bulk load, fill " : "insert-built, fill ") << std::fixed
+                      << std::setprecision(2) << fill << ": " << queries << " queries, " << returned
+                      << " RIDs compared" << std::endl;
+
+            // Incremental deletes: 60% of the rows in random order with
+            // periodic structural checks, queries over the survivors, then
+            // the rest, which must leave every tree empty
+            std::vector<size_t> order(rows.size());
+            for (size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::shuffle(order.begin(), order.end(), rng);
+            const size_t first_part = order.size() * 3 / 5;
+            const size_t check_every = std::max<size_t>(1, first_part / 8);
+            bool intact = true;
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                const auto &row = rows[order[i]];
+                if (!im.removeRecord(row.second, row.first.first, row.first.second))
+                    mismatches++;
+                alive[order[i]] = 0;
+                if (i < first_part && (i + 1) % check_every == 0)
+                    intact = im.checkIntegrity() && intact;
+                if (i + 1 == first_part)
+                {
+                    returned = 0;
+                    mismatches += runQueries(im, queries / 5);
+                    std::cout << "    after deleting " << first_part << " rows: " << queries / 5 << " queries, "
+                              << returned << " RIDs compared" << std::endl;
+                }
+            }
+            intact = im.checkIntegrity() && intact;
+            const bool empty = im.searchByPointsRange(INT_MIN, INT_MAX).empty() &&
+                               im.searchByDateRange(INT_MIN, INT_MAX).empty() &&
+                               im.searchByFTPercentage(-1.0f, 2.0f).empty();
+            std::cout << "    after deleting all " << rows.size() << " rows: trees "
+                      << (empty ? "empty" : "NOT empty") << ", integrity " << (intact ? "ok" : "FAILED")
+                      << std::endl;
+            if (!intact || !empty)
+                mismatches++;
+            std::fill(alive.begin(), alive.end(), 1);
+        }
+
+        // FT% > 0.9 as the delete set: per-record index maintenance against
+        // rebuilding every index without the tombstoned rows
+        {
+            IndexManager incremental, rebuilt;
+            incremental.buildIndexes(db);
+            const DeletionStats del = db.deleteByFTAboveLinear(0.9f);
+            auto t0 = bench_clock::now();
+            for (const auto &row : rows)
+                if (row.second.ft_pct_home > 0.9f)
+                    incremental.removeRecord(row.second, row.first.first, row.first.second);
+            const double incremental_ms = elapsedMs(t0);
+            t0 = bench_clock::now();
+            rebuilt.buildIndexesSkippingDeleted(db);
+            const double rebuild_ms = elapsedMs(t0);
+            db.clearDeleted();
+            if (incremental.searchByFTPercentage(-1.0f, 2.0f) != rebuilt.searchByFTPercentage(-1.0f, 2.0f) ||
+                incremental.searchByPointsRange(INT_MIN, INT_MAX) != rebuilt.searchByPointsRange(INT_MIN, INT_MAX))
+                mismatches++;
+            std::cout << "  Deleting " << del.nDeleted << " rows (FT% > 0.9): in-place index updates "
+                      << std::setprecision(2) << incremental_ms << " ms, full rebuild " << rebuild_ms << " ms"
+                      << std::endl;
+        }
+        std::cout << "  Mismatches: " << mismatches << std::endl;
+
+        // Equality and date-range lookups: one descent + leaf sweep vs a full scan
+        IndexManager im;
+        im.buildIndexes(db);
+        std::cout << "\n=== Lookups: index vs vectorized full scan (best of 5) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(28) << "lookup" << std::right << std::setw(12) << "index us"
+                  << std::setw(12) << "scan us" << std::setw(10) << "speedup" << std::setw(12) << "records"
+                  << std::endl;
+        const GameRecord &probe = rows[rows.size() / 2].second;
+        struct Lookup
+        {
+            std::string name;
+            std::function<Rids()> index;
+            std::vector<ScanPredicate> preds;
+        };
+        const Lookup lookups[] = {
+            {"team_id = " + std::to_string(probe.team_id_home),
+             [&]() { return im.searchByTeamId(probe.team_id_home); },
+             {ScanPredicate::equals(GameColumn::TeamId, probe.team_id_home)}},
+            {"pts_home = " + std::to_string(probe.pts_home),
+             [&]() { return im.searchByPointsRange(probe.pts_home, probe.pts_home); },
+             {ScanPredicate::equals(GameColumn::Points, probe.pts_home)}},
+            {"pts_home = 160",
+             [&]() { return im.searchByPointsRange(160, 160); },
+             {ScanPredicate::equals(GameColumn::Points, 160)}},
+            {"2019-20 season (date range)",
+             [&]() { return im.searchByDateRange(20191001, 20201031); },
+             {ScanPredicate::between(GameColumn::Date, 20191001, 20201031)}},
+            {"team + season (composite)",
+             [&]() { return im.searchByTeamAndDateRange(probe.team_id_home, 20191001, 20201031); },
+             {ScanPredicate::equals(GameColumn::TeamId, probe.team_id_home),
+              ScanPredicate::between(GameColumn::Date, 20191001, 20201031)}},
+            {"team + season (intersect)",
+             [&]()
+             {
+                 // What the composite index replaces: two RID lists joined in code
+                 Rids team = sorted(im.searchByTeamId(probe.team_id_home));
+                 Rids season = sorted(im.searchByDateRange(20191001, 20201031));
+                 Rids both;
+                 std::set_intersection(team.begin(), team.end(), season.begin(), season.end(),
+                                       std::back_inserter(both));
+                 return both;
+             },
+             {ScanPredicate::equals(GameColumn::TeamId, probe.team_id_home),
+              ScanPredicate::between(GameColumn::Date, 20191001, 20201031)}}};
+        for (const auto &l : lookups)
+        {
+            size_t found = 0;
+            const double index_ms = bestOf(5, [&]() { found = l.index().size(); });
+            const double scan_ms = bestOf(5, [&]() { db.scan(l.preds); });
+            std::cout << "  " << std::left << std::setw(28) << l.name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(12) << index_ms * 1000.0 << std::setw(12)
+                      << scan_ms * 1000.0 << std::setw(9) << scan_ms / index_ms << "x" << std::setw(12) << found
+                      << std::endl;
+        }
+
+        // Aggregate without touching the heap: covering keys vs fetching each match
+        db.buildIndexes();
+        CoveredStats heap, covered;
+        const double heap_ms = bestOf(5, [&]() { heap = db.aggregateFTAbove(0.9f, false); });
+        const double covered_ms = bestOf(5, [&]() { covered = db.aggregateFTAbove(0.9f, true); });
+        std::cout << "  avg PTS, FT% > 0.9 (" << covered.rows << " records): index-only " << std::setprecision(1)
+                  << covered_ms * 1000.0 << " us, " << covered.nData << " data blocks; heap fetch "
+                  << heap_ms * 1000.0 << " us, " << heap.nData << " data blocks" << std::endl;
+        if (heap.rows != covered.rows || heap.sumPts != covered.sumPts || heap.wins != covered.wins)
+            mismatches++;
+
+        // Rows tombstoned before any index exists must stay out of a later build
+        DatabaseFile tombstoned("bench_index_tombstoned.db");
+        std::streambuf *saved = std::cout.rdbuf(nullptr); // loads, deletes and builds narrate
+        const bool built = loadScaled(tombstoned, data_file, 1) &&
+                           tombstoned.deleteByFTAboveLinear(0.95f).nDeleted > 0 && tombstoned.buildIndexes();
+        std::cout.rdbuf(saved);
+        heap = tombstoned.aggregateFTAbove(0.9f, false);
+        covered = tombstoned.aggregateFTAbove(0.9f, true);
+        std::cout << "  after a delete with no indexes: index-only " << covered.rows << " records, heap fetch "
+                  << heap.rows << " records" << std::endl;
+        if (!built || heap.rows != covered.rows || heap.sumPts != covered.sumPts || heap.wins != covered.wins)
+            mismatches++;
+        return mismatches == 0;
+    }
+
+    // Child-slot search inside one node for each index key type (int
+    // pts_home, float ft_pct_home, game_date as an int YYYYMMDD and as the day
+    // code the date index keys on): the original linear
+    // scan against std::upper_bound, the branchless binary search and the
+    // SIMD compare-and-count kernels, at the tree fanout and larger nodes
+    void nodeSearch(const std::string &data_file)
+    {
+        DatabaseFile db("bench_nodesearch.db");
+        if (!db.loadFromTextFile(data_file))
+            return;
+        std::vector<int> points;
+        std::vector<float> ft_pct;
+        std::vector<int> dates;
+        std::vector<DayCode> day_codes;
+        for (size_t b = 0; b < db.getTotalBlocks(); b++)
+        {
+            BlockRef blk = db.getBlock(b);
+            for (int r = 0; r < blk->record_count; r++)
+            {
+                const GameRecord rec = blk->getRecord(r);
+                points.push_back(rec.pts_home);
+                ft_pct.push_back(rec.ft_pct_home);
+                dates.push_back(rec.game_date);
+                day_codes.push_back(DayCode::fromDateKey(rec.game_date));
+            }
+        }
+
+        std::mt19937 rng(7);
+        for (int fanout : {BPlusTreeNode<int>::MAX_KEYS, 64, 256})
+        {
+            nodeSearchRun("int (pts_home)", points, fanout, rng);
+            nodeSearchRun("float (ft_pct_home)", ft_pct, fanout, rng);
+            nodeSearchRun("int (game_date)", dates, fanout, rng);
+            nodeSearchRun("DayCode (game_date)", day_codes, fanout, rng);
+        }
+    }
+
+    // Fanout sweep per index (8 .. 256 keys per node and the page-sized
+    // default) over games.txt scaled up: tree height, node count and memory,
+    // bulk and insert build time, and point-lookup latency
+    void fanout(const std::string &data_file, int scale)
+    {
+        DatabaseFile db("bench_fanout.db");
+        if (!loadScaled(db, data_file, scale))
+            return;
+        std::vector<IndexEntry<int>> team, points;
+        std::vector<IndexEntry<float>> fg_pct, ft_pct;
+        std::vector<IndexEntry<int>> dates;
+        std::vector<IndexEntry<DayCode>> day_codes;
+        for (size_t b = 0; b < db.getTotalBlocks(); b++)
+        {
+            BlockRef blk = db.getBlock(b);
+            for (int r = 0; r < blk->record_count; r++)
+            {
+                const GameRecord rec = blk->getRecord(r);
+                team.push_back({rec.team_id_home, (int)b, r});
+                points.push_back({rec.pts_home, (int)b, r});
+                fg_pct.push_back({rec.fg_pct_home, (int)b, r});
+                ft_pct.push_back({rec.ft_pct_home, (int)b, r});
+                dates.push_back({rec.game_date, (int)b, r});
+                day_codes.push_back({DayCode::fromDateKey(rec.game_date), (int)b, r});
+            }
+        }
+
+        std::mt19937 rng(11);
+        fanoutSweep("Team ID", team, std::vector<int>{0, 42, 1610612700}, rng);
+        fanoutSweep("Points", points, std::vector<int>{-1, 0, 500}, rng);
+        fanoutSweep("FG Percentage", fg_pct, std::vector<float>{-1.0f, 0.4445f, 2.0f}, rng);
+        fanoutSweep("FT Percentage", ft_pct, std::vector<float>{-1.0f, 0.7775f, 2.0f}, rng);
+        fanoutSweep("Date (YYYYMMDD)", dates, std::vector<int>{0, 20150231, 99991231}, rng);
+        fanoutSweep("Date (day codes)", day_codes,
+                    std::vector<DayCode>{DayCode{0}, DayCode::fromDateKey(19000101), DayCode{0xffff}}, rng);
+    }
+
+    // Index matches materialized in key order (one getBlock() per RID) against
+    // the sorted, block-grouped fetch behind DatabaseFile::searchBy*, in
+    // memory and through a 64-frame buffer pool, where the key-order walk
+    // keeps re-reading evicted blocks
+    void fetch(const std::string &data_file, int scale)
+    {
+        typedef std::vector<std::pair<int, int>> Rids;
+        DatabaseFile db("bench_fetch.db");
+        if (!loadScaled(db, data_file, scale) || !db.writeBlocksToDisk() || !db.buildIndexes() ||
+            !db.writeIndexesToDisk())
+            return;
+        IndexManager im;
+        im.buildIndexes(db);
+        DatabaseFile pooled("bench_fetch.db");
+        if (!pooled.openWithBufferPool(64) || !pooled.readIndexesFromDisk())
+            return;
+
+        struct Query
+        {
+            std::string name;
+            std::function<Rids()> rids;
+            std::function<std::vector<GameRecord>(DatabaseFile &, size_t *)> grouped;
+        };
+        const Query queries[] = {
+            {"team_id = 1610612744", [&]() { return im.searchByTeamId(1610612744); },
+             [](DatabaseFile &d, size_t *blocks) { return d.searchByTeamId(1610612744, blocks); }},
+            {"pts_home 110-120", [&]() { return im.searchByPointsRange(110, 120); },
+             [](DatabaseFile &d, size_t *blocks) { return d.searchByPointsRange(110, 120, blocks); }},
+            {"fg_pct_home 0.5-0.6", [&]() { return im.searchByFGPercentage(0.5f, 0.6f); },
+             [](DatabaseFile &d, size_t *blocks) { return d.searchByFGPercentage(0.5f, 0.6f, blocks); }},
+            {"ft_pct_home 0.9-1.0", [&]() { return im.searchByFTPercentage(0.9f, 1.0f); },
+             [](DatabaseFile &d, size_t *blocks) { return d.searchByFTPercentage(0.9f, 1.0f, blocks); }},
+            {"2019-20 season", [&]() { return im.searchByDateRange(20191001, 20201031); },
+             [](DatabaseFile &d, size_t *blocks) { return d.searchByDateRange("2019-10-01", "2020-10-31", blocks); }}};
+
+        auto keyOrder = [](DatabaseFile &d, const Rids &rids)
+        {
+            std::vector<GameRecord> out;
+            out.reserve(rids.size());
+            for (const auto &loc : rids)
+                out.push_back(d.getBlock(loc.first)->getRecord(loc.second));
+            return out;
+        };
+
+        std::cout << "\n=== Index fetch: key order vs block-grouped, " << db.getTotalRecords() << " records in "
+                  << db.getTotalBlocks() << " blocks (best of 5) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(22) << "query" << std::right << std::setw(9) << "records"
+                  << std::setw(8) << "blocks" << std::setw(12) << "key ms" << std::setw(12) << "grouped ms"
+                  << std::setw(14) << "pool key ms" << std::setw(14) << "pool grp ms" << std::setw(12)
+                  << "key misses" << std::setw(12) << "grp misses" << std::endl;
+        for (const auto &q : queries)
+        {
+            const Rids rids = q.rids();
+            size_t blocks = 0, found = 0;
+            const double key_ms = bestOf(5, [&]() { found = keyOrder(db, q.rids()).size(); });
+            const double grouped_ms = bestOf(5, [&]() { q.grouped(db, &blocks); });
+
+            // One cold pass each for the miss counts, then the timed runs
+            pooled.resetBufferPoolStatistics();
+            keyOrder(pooled, rids);
+            const uint64_t key_misses = pooled.getBufferPoolStats().misses;
+            pooled.resetBufferPoolStatistics();
+            q.grouped(pooled, nullptr);
+            const uint64_t grouped_misses = pooled.getBufferPoolStats().misses;
+            const double pool_key_ms = bestOf(5, [&]() { keyOrder(pooled, q.rids()); });
+            const double pool_grouped_ms = bestOf(5, [&]() { q.grouped(pooled, nullptr); });
+
+            std::cout << "  " << std::left << std::setw(22) << q.name << std::right << std::setw(9) << found
+                      << std::setw(8) << blocks << std::fixed << std::setprecision(3) << std::setw(12) << key_ms
+                      << std::setw(12) << grouped_ms << std::setw(14) << pool_key_ms << std::setw(14)
+                      << pool_grouped_ms << std::setw(12) << key_misses << std::setw(12) << grouped_misses
+                      << std::endl;
+        }
+    }
+
+    // Streaming search: RID cursors drained in random batch sizes must match
+    // the materialized searches RID for RID; then time to first row, LIMIT 10
+    // and a full drain for wide ranges, against searchBy*() building the
+    // whole result. Returns false on any mismatch.
+    bool cursors(const std::string &data_file, int scale)
+    {
+        typedef std::vector<std::pair<int, int>> Rids;
+        DatabaseFile db("bench_cursor.db");
+        if (!loadScaled(db, data_file, scale) || !db.buildIndexes())
+            return false;
+        IndexManager im;
+        im.buildIndexes(db);
+
+        const unsigned seed = 20260301u;
+        std::mt19937 rng(seed);
+        size_t mismatches = 0, compared = 0;
+        for (int q = 0; q < 200; q++)
+        {
+            const int lo = (int)(rng() % 160), hi = lo + (int)(rng() % 60);
+            const float flo = (rng() % 1000) / 1000.0f, fhi = flo + (rng() % 300) / 1000.0f;
+            Rids want;
+            std::unique_ptr<RidCursor> cursor;
+            switch (q % 4)
+            {
+            case 0:
+                want = im.searchByPointsRange(lo, hi);
+                cursor = im.cursorByPointsRange(lo, hi);
+                break;
+            case 1:
+                want = im.searchByFTPercentage(flo, fhi);
+                cursor = im.cursorByFTPercentage(flo, fhi);
+                break;
+            case 2:
+                want = im.searchByDateRange(20000000 + lo * 1000, 20000000 + hi * 1000);
+                cursor = im.cursorByDateRange(20000000 + lo * 1000, 20000000 + hi * 1000);
+                break;
+            default:
+            {
+                const int team = 1610612737 + (int)(rng() % 32);
+                want = im.searchByTeamId(team);
+                cursor = im.cursorByTeamId(team);
+                break;
+            }
+            }
+            Rids got, batch;
+            for (;;)
+            {
+                batch.resize(1 + rng() % (q % 3 == 0 ? 3 : 2000));
+                const size_t n = cursor->next(batch.data(), batch.size());
+                if (n == 0)
+                    break;
+                got.insert(got.end(), batch.begin(), batch.begin() + n);
+            }
+            compared += want.size();
+            if (got != want)
+                mismatches++;
+        }
+        std::cout << "\n=== Cursor check: " << db.getTotalRecords() << " records, 200 ranges, " << compared
+                  << " RIDs, seed " << seed << " ===" << std::endl;
+        std::cout << "  Mismatches: " << mismatches << std::endl;
+
+        std::cout << "\n=== Wide ranges: materialized vs cursor (best of 5) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(22) << "query" << std::right << std::setw(9) << "rows"
+                  << std::setw(14) << "search ms" << std::setw(14) << "search KB" << std::setw(14)
+                  << "1st row us" << std::setw(12) << "LIMIT 10 us" << std::setw(12) << "drain ms"
+                  << std::setw(12) << "cursor KB" << std::endl;
+        struct Wide
+        {
+            std::string name;
+            std::function<std::vector<GameRecord>()> search;
+            std::function<RecordCursor(size_t)> open;
+        };
+        const Wide wides[] = {
+            {"pts_home 0-200", [&]() { return db.searchByPointsRange(0, 200); },
+             [&](size_t limit) { return db.cursorByPointsRange(0, 200, limit); }},
+            {"fg_pct_home 0-1", [&]() { return db.searchByFGPercentage(0.0f, 1.0f); },
+             [&](size_t limit) { return db.cursorByFGPercentage(0.0f, 1.0f, limit); }},
+            {"2000-2020 (date)", [&]() { return db.searchByDateRange("2000-01-01", "2020-12-31"); },
+             [&](size_t limit) { return db.cursorByDateRange("2000-01-01", "2020-12-31", limit); }}};
+        const size_t no_limit = std::numeric_limits<size_t>::max();
+        for (const auto &w : wides)
+        {
+            size_t rows = 0, search_bytes = 0, drained = 0;
+            const double search_ms = bestOf(5, [&]()
+            {
+                std::vector<GameRecord> all = w.search();
+                rows = all.size();
+                // The result plus the RID vector it was built from
+                search_bytes = all.capacity() * sizeof(GameRecord) + rows * sizeof(std::pair<int, int>);
+            });
+            const double first_ms = bestOf(5, [&]()
+            {
+                RecordCursor c = w.open(no_limit);
+                GameRecord g;
+                c.next(g);
+            });
+            const double limit_ms = bestOf(5, [&]()
+            {
+                RecordCursor c = w.open(10);
+                GameRecord g;
+                while (c.next(g))
+                {
+                }
+            });
+            std::vector<GameRecord> batch;
+            const double drain_ms = bestOf(5, [&]()
+            {
+                RecordCursor c = w.open(no_limit);
+                drained = 0;
+                while (c.nextBatch(batch, 1000) > 0)
+                    drained += batch.size();
+            });
+            if (drained != rows)
+                mismatches++;
+            // One RID batch, its records, and the caller's 1000-row batch
+            const size_t cursor_bytes = RecordCursor::BATCH_RIDS * (sizeof(GameRecord) + sizeof(std::pair<int, int>)) +
+                                        batch.capacity() * sizeof(GameRecord);
+            std::cout << "  " << std::left << std::setw(22) << w.name << std::right << std::setw(9) << rows
+                      << std::fixed << std::setprecision(2) << std::setw(14) << search_ms << std::setw(14)
+                      << search_bytes / 1024 << std::setprecision(1) << std::setw(14) << first_ms * 1000.0
+                      << std::setw(12) << limit_ms * 1000.0 << std::setprecision(2) << std::setw(12) << drain_ms
+                      << std::setw(12) << cursor_bytes / 1024 << std::endl;
+        }
+        return mismatches == 0;
+    }
+
+    // Index memory behaviour: build time and resident-set growth of all seven
+    // indexes (bulk-loaded and insert-built, both kept alive so neither reuses
+    // the other's freed memory), full leaf sweeps of the four range indexes
+    // through cursors, and teardown time
+    void treeMemory(const std::string &data_file, int scale)
+    {
+        DatabaseFile db("bench_arena.db");
+        if (!loadScaled(db, data_file, scale))
+            return;
+        std::cout << "\n=== Index build, memory, sweep and teardown: " << db.getTotalRecords() << " records ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(10) << "build" << std::right << std::setw(11) << "build ms"
+                  << std::setw(10) << "RSS MB" << std::setw(13) << "sweep ms" << std::setw(14) << "M RIDs/s"
+                  << std::setw(14) << "teardown ms" << std::endl;
+
+        std::unique_ptr<IndexManager> managers[2];
+        double build_ms[2], rss_mb[2];
+        for (int m = 0; m < 2; m++)
+        {
+            const size_t before = residentBytes();
+            managers[m].reset(new IndexManager());
+            std::streambuf *saved = std::cout.rdbuf(nullptr); // buildIndexes() narrates
+            const auto t0 = bench_clock::now();
+            managers[m]->buildIndexes(db, m == 0);
+            build_ms[m] = elapsedMs(t0);
+            std::cout.rdbuf(saved);
+            rss_mb[m] = ((double)residentBytes() - (double)before) / 1048576.0;
+        }
+        for (int m = 0; m < 2; m++)
+        {
+            const IndexManager &im = *managers[m];
+            const float lo = std::numeric_limits<float>::lowest(), hi = std::numeric_limits<float>::max();
+            std::vector<std::pair<int, int>> batch(4096);
+            size_t rids = 0;
+            const double sweep_ms = bestOf(3, [&]()
+            {
+                std::unique_ptr<RidCursor> cursors[] = {
+                    im.cursorByPointsRange(INT_MIN, INT_MAX), im.cursorByFGPercentage(lo, hi),
+                    im.cursorByFTPercentage(lo, hi), im.cursorByDateRange(INT_MIN, INT_MAX)};
+                rids = 0;
+                for (auto &c : cursors)
+                    for (size_t n; (n = c->next(batch.data(), batch.size())) > 0;)
+                        rids += n;
+            });
+            const auto t0 = bench_clock::now();
+            managers[m].reset();
+            const double teardown_ms = elapsedMs(t0);
+            std::cout << "  " << std::left << std::setw(10) << (m == 0 ? "bulk" : "insert") << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(11) << build_ms[m] << std::setw(10)
+                      << rss_mb[m] << std::setw(13) << sweep_ms << std::setw(14) << rids / (sweep_ms * 1000.0)
+                      << std::setw(14) << teardown_ms << std::endl;
+        }
+    }
+
+    // The same blocks written raw and compressed: file size, open time, full
+    // scans (zone maps off, so every block is evaluated) on the raw blocks in
+    // memory against the encoded columns, and decoding every block. Scan
+    // results must match.
+    bool compression(const std::string &data_file, int scale)
+    {
+        DatabaseFile raw("bench_compress_raw.db");
+        DatabaseFile packed("bench_compress.db");
+        packed.setBlockEncoding(BlockEncoding::Compressed);
+        std::streambuf *saved = std::cout.rdbuf(nullptr); // loads and opens narrate
+        const bool written = loadScaled(raw, data_file, scale) && raw.writeBlocksToDisk() &&
+                             loadScaled(packed, data_file, scale) && packed.writeBlocksToDisk();
+        DatabaseFile reopened("bench_compress.db");
+        const double raw_open_ms = bestOf(3, [&]() { raw.readBlocksFromDisk(); });
+        const double packed_open_ms = bestOf(3, [&]() { reopened.openCompressed(); });
+        std::cout.rdbuf(saved);
+        if (!written || !reopened.isCompressed())
+            return false;
+
+        const size_t raw_bytes = fileBytes("bench_compress_raw.db");
+        const size_t packed_bytes = fileBytes("bench_compress.db");
+        std::cout << "\n=== Block compression: " << data_file << " x" << scale << ", " << raw.getTotalRecords()
+                  << " records in " << raw.getTotalBlocks() << " blocks ===" << std::endl;
+        std::cout << "  raw file " << std::fixed << std::setprecision(2) << raw_bytes / 1048576.0
+                  << " MB, compressed " << packed_bytes / 1048576.0 << " MB (" << std::setprecision(1)
+                  << (double)raw_bytes / packed_bytes << "x smaller)" << std::endl;
+        printRow("open raw", raw_open_ms, raw_bytes, raw.getTotalBlocks(), "blocks");
+        printRow("open packed", packed_open_ms, packed_bytes, reopened.getTotalBlocks(), "blocks");
+
+        const std::pair<const char *, std::vector<ScanPredicate>> queries[] = {
+            {"2014-15 season", {ScanPredicate::between(GameColumn::Date, 20141001, 20150630)}},
+            {"FT% > 0.9", {ScanPredicate::greaterThan(GameColumn::FtPct, 0.9)}},
+            {"PTS 100-120, 3P% > .4",
+             {ScanPredicate::between(GameColumn::Points, 100, 120), ScanPredicate::greaterThan(GameColumn::Fg3Pct, 0.4)}},
+            {"one team, home wins",
+             {ScanPredicate::equals(GameColumn::TeamId, 1610612744), ScanPredicate::equals(GameColumn::HomeTeamWins, 1)}}};
+        int mismatches = 0;
+        for (const auto &q : queries)
+        {
+            std::vector<std::pair<int, int>> expected, got;
+            raw.setZoneMapsEnabled(false);
+            reopened.setZoneMapsEnabled(false);
+            const double raw_ms = bestOf(5, [&]() { expected = raw.scan(q.second); });
+            const double packed_ms = bestOf(5, [&]() { got = reopened.scan(q.second); });
+            printRow(std::string(q.first) + " raw", raw_ms, raw_bytes, expected.size());
+            printRow(std::string(q.first) + " packed", packed_ms, packed_bytes, got.size());
+            if (got != expected)
+                mismatches++;
+            raw.setZoneMapsEnabled(true);
+            reopened.setZoneMapsEnabled(true);
+            if (reopened.scan(q.second) != raw.scan(q.second))
+                mismatches++;
+        }
+
+        size_t rows = 0;
+        const double decode_ms = bestOf(3, [&]()
+        {
+            rows = 0;
+            for (size_t b = 0; b < reopened.getTotalBlocks(); b++)
+            {
+                BlockRef blk = reopened.getBlock(b);
+                BlockRef expected = raw.getBlock(b);
+                rows += blk->record_count;
+                if (blk->record_count != expected->record_count)
+                    mismatches++;
+                for (int r = 0; r < blk->record_count && r < expected->record_count; r++)
+                    for (int c = 0; c < GAME_COLUMN_COUNT; c++)
+                        if (std::memcmp(blk->column((GameColumn)c).at(r), expected->column((GameColumn)c).at(r),
+                                        Block::columnWidth((GameColumn)c)) != 0)
+                            mismatches++;
+            }
+        });
+        printRow("decode + check every block", decode_ms, raw_bytes, rows);
+
+        // Reloading text over the compressed open must leave compressed mode:
+        // the new blocks are served and take new records
+        DatabaseFile text("bench_compress_raw.db");
+        saved = std::cout.rdbuf(nullptr);
+        const bool reloaded = reopened.loadFromTextFile(data_file) && text.loadFromTextFile(data_file);
+        std::cout.rdbuf(saved);
+        const std::vector<ScanPredicate> every_row = {ScanPredicate::atLeast(GameColumn::Points, 0)};
+        if (!reloaded || reopened.isCompressed() || reopened.getTotalBlocks() != text.getTotalBlocks() ||
+            reopened.scan(every_row) != text.scan(every_row) ||
+            !sameRecord(reopened.getBlock(0)->getRecord(0), text.getBlock(0)->getRecord(0)) ||
+            !reopened.addRecord(text.getBlock(0)->getRecord(0)))
+            mismatches++;
+        std::cout << "  Reload after compressed open: " << (reloaded ? reopened.getTotalRecords() : 0)
+                  << " records" << std::endl;
+        std::cout << "  Mismatches: " << mismatches << std::endl;
+        return mismatches == 0;
+    }
+
+    // Live ingest of games.txt on top of games.txt x scale. Durability by
+    // rewriting the file every 64 records (writeBlocksToDisk() + fsync)
+    // against appendRecord() through the write-ahead log at several commit
+    // batches, each followed by an in-place checkpoint. Then recovery: log
+    // replay on open (in memory and through a buffer pool), a torn last
+    // frame and a reopen after checkpoint must give back exactly the
+    // records appended.
+    bool writeAheadLog(const std::string &data_file, int scale)
+    {
+        const std::string path = "bench_wal.db";
+        std::remove((path + ".wal").c_str());
+        std::vector<GameRecord> expected, live;
+        std::streambuf *saved = std::cout.rdbuf(nullptr); // loads, opens and checkpoints narrate
+        {
+            DatabaseFile src("bench_source.db");
+            DatabaseFile base(path);
+            if (!src.loadFromTextFile(data_file) || !loadScaled(base, data_file, scale) || !base.writeBlocksToDisk())
+            {
+                std::cout.rdbuf(saved);
+                return false;
+            }
+            for (size_t b = 0; b < src.getTotalBlocks(); b++)
+            {
+                BlockRef blk = src.getBlock(b);
+                for (int r = 0; r < blk->record_count; r++)
+                    live.push_back(blk->getRecord(r));
+            }
+            for (size_t b = 0; b < base.getTotalBlocks(); b++)
+            {
+                BlockRef blk = base.getBlock(b);
+                for (int r = 0; r < blk->record_count; r++)
+                    expected.push_back(blk->getRecord(r));
+            }
+        }
+        const size_t base_bytes = fileBytes(path);
+        std::cout.rdbuf(saved);
+
+        std::cout << "\n=== Write-ahead log: " << live.size() << " live records onto " << data_file << " x" << scale
+                  << " (" << expected.size() << " records, " << std::fixed << std::setprecision(1)
+                  << base_bytes / 1048576.0 << " MB) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(26) << "durability" << std::right << std::setw(8) << "records"
+                  << std::setw(12) << "records/s" << std::setw(10) << "fsyncs" << std::setw(12) << "MB written"
+                  << std::setw(10) << "MB/s" << std::setw(16) << "checkpoint ms" << std::endl;
+        auto printLine = [](const std::string &name, size_t records, double ms, uint64_t syncs, double bytes,
+                            double checkpoint_ms)
+        {
+            std::cout << "  " << std::left << std::setw(26) << name << std::right << std::setw(8) << records
+                      << std::setw(12) << std::setprecision(0) << records / (ms / 1000.0) << std::setw(10) << syncs
+                      << std::setw(12) << std::setprecision(1) << bytes / 1048576.0 << std::setw(10)
+                      << bytes / 1048576.0 / (ms / 1000.0) << std::setw(16) << std::setprecision(2);
+            if (checkpoint_ms >= 0)
+                std::cout << checkpoint_ms;
+            else
+                std::cout << "-";
+            std::cout << std::endl;
+        };
+
+        // Whole-file rewrites cost O(file) per batch, so only a prefix
+        {
+            const size_t n = std::min<size_t>(live.size(), 2048);
+            DatabaseFile db("bench_wal_rewrite.db");
+            saved = std::cout.rdbuf(nullptr);
+            loadScaled(db, data_file, scale);
+            db.writeBlocksToDisk();
+            uint64_t bytes = 0, syncs = 0;
+            const auto t0 = bench_clock::now();
+            for (size_t i = 0; i < n; i++)
+            {
+                db.addRecord(live[i]);
+                if ((i + 1) % 64 == 0 || i + 1 == n)
+                {
+                    db.writeBlocksToDisk();
+                    WriteAheadLog::syncFile("bench_wal_rewrite.db");
+                    bytes += fileBytes("bench_wal_rewrite.db");
+                    syncs++;
+                }
+            }
+            const double ms = elapsedMs(t0);
+            std::cout.rdbuf(saved);
+            printLine("rewrite file every 64", n, ms, syncs, (double)bytes, -1);
+        }
+
+        int mismatches = 0;
+        const size_t batches[] = {1, 8, 64, 512};
+        for (size_t batch : batches)
+        {
+            DatabaseFile db(path);
+            saved = std::cout.rdbuf(nullptr);
+            const bool opened = db.readBlocksFromDisk();
+            db.setCommitBatch(batch);
+            const auto t0 = bench_clock::now();
+            bool appended = opened;
+            for (size_t i = 0; i < live.size() && appended; i++)
+                appended = db.appendRecord(live[i]);
+            appended = appended && db.commit();
+            const double ms = elapsedMs(t0);
+            const WalStats stats = db.getWalStats();
+            const auto t1 = bench_clock::now();
+            const bool checkpointed = db.checkpoint();
+            const double checkpoint_ms = elapsedMs(t1);
+            std::cout.rdbuf(saved);
+            if (!appended || !checkpointed || db.getTotalRecords() != expected.size() + live.size())
+                mismatches++;
+            expected.insert(expected.end(), live.begin(), live.end());
+            printLine("log, commit batch " + std::to_string(batch), live.size(), ms, stats.commits,
+                      (double)stats.bytes, checkpoint_ms);
+        }
+
+        // Recovery: append without a checkpoint, then reopen
+        auto matches = [&](const DatabaseFile &db)
+        {
+            size_t i = 0;
+            for (size_t b = 0; b < db.getTotalBlocks(); b++)
+            {
+                BlockRef blk = db.getBlock(b);
+                for (int r = 0; r < blk->record_count; r++, i++)
+                    if (i >= expected.size() || !sameRecord(blk->getRecord(r), expected[i]))
+                        return false;
+            }
+            return i == expected.size() && db.getTotalRecords() == expected.size();
+        };
+        const size_t logged = 1000;
+        saved = std::cout.rdbuf(nullptr);
+        {
+            DatabaseFile db(path);
+            db.readBlocksFromDisk();
+            db.setCommitBatch(64);
+            for (size_t i = 0; i < logged; i++)
+                db.appendRecord(live[i]);
+        } // the pending batch is committed on close
+        expected.insert(expected.end(), live.begin(), live.begin() + logged);
+        DatabaseFile reopened(path);
+        const double replay_ms = bestOf(1, [&]() { reopened.readBlocksFromDisk(); });
+        const bool replay_ok = matches(reopened);
+
+        // A crash mid-write tears the last frame (1000 = 15 x 64 + 40): cut
+        // into it, and the 40 records it held must be gone, the rest kept.
+        // The buffer-pool open replays the same log, and on close writes the
+        // records back, so it goes last before the checkpoint.
+        std::string log;
+        {
+            std::ifstream in(path + ".wal", std::ios::binary);
+            log.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        std::ofstream(path + ".wal", std::ios::binary | std::ios::trunc).write(log.data(), log.size() - 7);
+        expected.resize(expected.size() - (logged % 64));
+        bool torn_ok, pool_ok, checkpoint_ok;
+        {
+            DatabaseFile db(path);
+            torn_ok = db.readBlocksFromDisk() && matches(db);
+        }
+        {
+            DatabaseFile db(path);
+            pool_ok = db.openWithBufferPool(64) && matches(db);
+        }
+        {
+            DatabaseFile db(path);
+            checkpoint_ok = db.readBlocksFromDisk() && db.checkpoint();
+        }
+        {
+            DatabaseFile db(path);
+            checkpoint_ok = checkpoint_ok && db.readBlocksFromDisk() && matches(db) && fileBytes(path + ".wal") == 16;
+        }
+
+        // A full rewrite retires the log: records logged in an earlier session
+        // must not come back over a file rewritten from a fresh load, and ones
+        // logged before a rewrite in the same session must not come back twice
+        const size_t stale = 10;
+        bool rewrite_ok;
+        {
+            DatabaseFile db(path);
+            rewrite_ok = db.readBlocksFromDisk();
+            for (size_t i = 0; i < stale; i++)
+                rewrite_ok = rewrite_ok && db.appendRecord(live[i]);
+        }
+        {
+            DatabaseFile db(path);
+            rewrite_ok = rewrite_ok && db.loadFromTextFile(data_file) && db.writeBlocksToDisk();
+        }
+        expected = live;
+        {
+            DatabaseFile db(path);
+            rewrite_ok = rewrite_ok && db.readBlocksFromDisk() && matches(db);
+            for (size_t i = 0; i < 2 * stale; i++)
+                rewrite_ok = rewrite_ok && db.appendRecord(live[i]);
+            rewrite_ok = rewrite_ok && db.writeBlocksToDisk();
+            for (size_t i = 0; i < stale; i++)
+                rewrite_ok = rewrite_ok && db.appendRecord(live[i]);
+        }
+        expected.insert(expected.end(), live.begin(), live.begin() + 2 * stale);
+        expected.insert(expected.end(), live.begin(), live.begin() + stale);
+        {
+            DatabaseFile db(path);
+            rewrite_ok = rewrite_ok && db.readBlocksFromDisk() && matches(db);
+        }
+        std::cout.rdbuf(saved);
+        mismatches += !replay_ok + !torn_ok + !pool_ok + !checkpoint_ok + !rewrite_ok;
+        std::cout << "  replay " << logged << " logged records on open: " << std::setprecision(2) << replay_ms
+                  << " ms, " << (replay_ok ? "match" : "MISMATCH") << std::endl;
+        std::cout << "  torn last frame: " << (torn_ok ? "dropped" : "NOT DROPPED") << " in memory, "
+                  << (pool_ok ? "dropped" : "NOT DROPPED") << " through a buffer pool" << std::endl;
+        std::cout << "  reopen after checkpoint, empty log: " << (checkpoint_ok ? "match" : "MISMATCH") << std::endl;
+        std::cout << "  reopen after a full rewrite: " << (rewrite_ok ? "match" : "MISMATCH") << std::endl;
+        std::cout << "  Mismatches: " << mismatches << std::endl;
+        return mismatches == 0;
+    }
+
+    int run(const std::string &name, const std::string &data_file)
+    {
+        if (name == "tokenizer")
+            tokenizer(data_file, 50);
+        else if (name == "scan")
+            scan(data_file, 50);
+        else if (name == "zonemap")
+            zoneMaps(data_file, 50);
+        else if (name == "threads")
+            threads(data_file, 50);
+        else if (name == "index")
+            return indexes(data_file, 10, 500) ? 0 : 1;
+        else if (name == "nodesearch")
+            nodeSearch(data_file);
+        else if (name == "fanout")
+            fanout(data_file, 10);
+        else if (name == "fetch")
+            fetch(data_file, 10);
+        else if (name == "cursor")
+            return cursors(data_file, 10) ? 0 : 1;
+        else if (name == "arena")
+            treeMemory(data_file, 10);
+        else if (name == "compress")
+            return compression(data_file, 10) ? 0 : 1;
+        else if (name == "wal")
+            return writeAheadLog(data_file, 10) ? 0 : 1;
+        else
+        {
+            std::cerr << "Unknown benchmark '" << name << "'. Available: tokenizer, scan, zonemap, threads, index, nodesearch, fanout, fetch, cursor, arena, compress, wal" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,218 @@
+#include "GameRecord.h"
+#include <algorithm>
+#include <limits>
+
+// =============================
+// CLOCK eviction
+// =============================
+void ClockPolicy::init(size_t frame_count)
+{
+    ref_bit.assign(frame_count, 0);
+    evictable.assign(frame_count, 0);
+    hand = 0;
+}
+
+void ClockPolicy::recordAccess(size_t frame)
+{
+    ref_bit[frame] = 1;
+}
+
+void ClockPolicy::setEvictable(size_t frame, bool is_evictable)
+{
+    evictable[frame] = is_evictable ? 1 : 0;
+}
+
+bool ClockPolicy::evict(size_t& frame)
+{
+    const size_t n = ref_bit.size();
+    // Two full sweeps: the first may only clear reference bits
+    for (size_t step = 0; step < 2 * n; ++step) {
+        size_t f = hand;
+        hand = (hand + 1) % n;
+        if (!evictable[f]) continue;
+        if (ref_bit[f]) { ref_bit[f] = 0; continue; }
+        evictable[f] = 0;
+        frame = f;
+        return true;
+    }
+    return false;
+}
+
+// =============================
+// LRU-K eviction
+// =============================
+void LRUKPolicy::init(size_t frame_count)
+{
+    history.assign(frame_count, {});
+    evictable.assign(frame_count, 0);
+    clock_ = 0;
+}
+
+void LRUKPolicy::recordAccess(size_t frame)
+{
+    auto& h = history[frame];
+    if (h.size() == k) h.erase(h.begin());
+    h.push_back(++clock_);
+}
+
+void LRUKPolicy::setEvictable(size_t frame, bool is_evictable)
+{
+    evictable[frame] = is_evictable ? 1 : 0;
+}
+
+bool LRUKPolicy::evict(size_t& frame)
+{
+    // Frames with < K accesses have infinite backward K-distance; among those
+    // the oldest first access wins, otherwise the oldest K-th access wins.
+    bool found = false, best_inf = false;
+    uint64_t best_time = std::numeric_limits<uint64_t>::max();
+    for (size_t f = 0; f < history.size(); ++f) {
+        if (!evictable[f]) continue;
+        const auto& h = history[f];
+        const bool inf = h.size() < k;
+        const uint64_t t = h.empty() ? 0 : h.front();
+        if (!found || (inf && !best_inf) || (inf == best_inf && t < best_time)) {
+            found = true;
+            best_inf = inf;
+            best_time = t;
+            frame = f;
+        }
+    }
+    if (!found) return false;
+    evictable[frame] = 0;
+    history[frame].clear();
+    return true;
+}
+
+// =============================
+// BufferPool
+// =============================
+BufferPool::BufferPool(size_t frame_count, std::unique_ptr<EvictionPolicy> eviction_policy)
+    : data_offset(0), frames(std::max<size_t>(1, frame_count)),
+      policy(eviction_policy ? std::move(eviction_policy)
+                             : std::unique_ptr<EvictionPolicy>(new ClockPolicy()))
+{
+    policy->init(frames.size());
+    free_frames.reserve(frames.size());
+    for (size_t i = frames.size(); i-- > 0;) free_frames.push_back(i);
+}
+
+BufferPool::~BufferPool()
+{
+    flushAll();
+}
+
+bool BufferPool::open(const std::string& path, size_t block_data_offset)
+{
+    if (file.is_open()) file.close();
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    data_offset = block_data_offset;
+    return file.is_open();
+}
+
+bool BufferPool::readFrame(Frame& f)
+{
+    file.clear();
+    file.seekg(data_offset + f.block_id * sizeof(Block));
+    file.read(reinterpret_cast<char*>(&f.block), sizeof(Block));
+    return (bool)file;
+}
+
+bool BufferPool::writeFrame(Frame& f)
+{
+    file.clear();
+    file.seekp(data_offset + f.block_id * sizeof(Block));
+    file.write(reinterpret_cast<const char*>(&f.block), sizeof(Block));
+    if (!file) return false;
+    f.dirty = false;
+    stats.writebacks++;
+    return true;
+}
+
+// Free frame if any, otherwise evict (writing back a dirty victim)
+bool BufferPool::claimFrame(size_t& frame)
+{
+    if (!free_frames.empty()) {
+        frame = free_frames.back();
+        free_frames.pop_back();
+        return true;
+    }
+    if (!policy->evict(frame)) return false;
+
+    Frame& victim = frames[frame];
+    if (victim.dirty && !writeFrame(victim)) {
+        std::cerr << "Error: Cannot write back block " << victim.block_id << std::endl;
+        policy->setEvictable(frame, true);
+        return false;
+    }
+    page_table.erase(victim.block_id);
+    victim.in_use = false;
+    stats.evictions++;
+    return true;
+}
+
+Block* BufferPool::fetchBlock(size_t block_id)
+{
+    auto it = page_table.find(block_id);
+    if (it != page_table.end()) {
+        Frame& f = frames[it->second];
+        stats.hits++;
+        if (f.pin_count++ == 0) policy->setEvictable(it->second, false);
+        policy->recordAccess(it->second);
+        return &f.block;
+    }
+
+    stats.misses++;
+    size_t frame;
+    if (!claimFrame(frame)) return nullptr; // every frame pinned
+
+    Frame& f = frames[frame];
+    f.block_id = block_id;
+    if (!readFrame(f)) {
+        free_frames.push_back(frame);
+        return nullptr;
+    }
+    f.pin_count = 1;
+    f.dirty = false;
+    f.in_use = true;
+    page_table[block_id] = frame;
+    policy->recordAccess(frame);
+    return &f.block;
+}
+
+Block* BufferPool::newBlock(size_t block_id)
+{
+    if (page_table.count(block_id)) return nullptr;
+    size_t frame;
+    if (!claimFrame(frame)) return nullptr;
+
+    Frame& f = frames[frame];
+    f.block = Block();
+    f.block_id = block_id;
+    f.pin_count = 1;
+    f.dirty = true;
+    f.in_use = true;
+    page_table[block_id] = frame;
+    policy->recordAccess(frame);
+    return &f.block;
+}
+
+void BufferPool::unpinBlock(size_t block_id, bool dirty)
+{
+    auto it = page_table.find(block_id);
+    if (it == page_table.end()) return;
+    Frame& f = frames[it->second];
+    if (dirty) f.dirty = true;
+    if (f.pin_count > 0 && --f.pin_count == 0) policy->setEvictable(it->second, true);
+}
+
+bool BufferPool::flushAll()
+{
+    if (!file.is_open()) return false;
+    bool ok = true;
+    for (auto& f : frames) {
+        if (f.in_use && f.dirty) ok = writeFrame(f) && ok;
+    }
+    file.flush();
+    return ok;
+}
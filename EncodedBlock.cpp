@@ -0,0 +1,398 @@
+#include "GameRecord.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Encoded block: record_count (uint16) | layout (uint8) | 0 (uint8) |
+// column_offset (uint16) per column, then per column in GameColumn order
+//   kind (uint8) | bits (uint8) | value_count (uint16) | base (int32) | max_code (uint32)
+//   value_count 4-byte values (dictionary entries or raw floats)
+//   record_count codes of `bits` bits, packed LSB first, rounded up to a byte
+// and CODE_SLACK zero bytes, so any code can be read with one 8-byte load.
+namespace {
+    const size_t BLOCK_HEADER_BYTES = 4 + 2 * GAME_COLUMN_COUNT;
+    const size_t COLUMN_HEADER_BYTES = 12;
+    const size_t CODE_SLACK = 8;
+    const int FIXED_POINT_SCALE = 1000;
+
+    int bitWidth(uint32_t max_code) {
+        int bits = 0;
+        while (bits < 32 && (max_code >> bits) != 0) ++bits;
+        return bits;
+    }
+
+    size_t packedBytes(int count, int bits) {
+        return ((size_t)count * bits + 7) / 8;
+    }
+
+    template<typename T>
+    void append(std::vector<char>& out, T value) {
+        const char* p = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    template<typename T>
+    T load(const char* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    void appendPacked(std::vector<char>& out, const std::vector<uint32_t>& codes, int bits) {
+        const size_t start = out.size();
+        out.resize(start + packedBytes((int)codes.size(), bits) + sizeof(uint64_t), 0);
+        for (size_t i = 0; i < codes.size() && bits > 0; ++i) {
+            const size_t bit = i * bits;
+            char* p = out.data() + start + bit / 8;
+            uint64_t word = load<uint64_t>(p);
+            word |= (uint64_t)codes[i] << (bit % 8);
+            std::memcpy(p, &word, sizeof(word));
+        }
+        out.resize(start + packedBytes((int)codes.size(), bits)); // drop the scratch tail
+    }
+
+    void appendColumnHeader(std::vector<char>& out, uint8_t kind, int bits, size_t value_count,
+                            int32_t base, uint32_t max_code) {
+        append<uint8_t>(out, kind);
+        append<uint8_t>(out, (uint8_t)bits);
+        append<uint16_t>(out, (uint16_t)value_count);
+        append<int32_t>(out, base);
+        append<uint32_t>(out, max_code);
+    }
+
+    // Frame of reference or dictionary, whichever packs smaller
+    void appendIntColumn(std::vector<char>& out, const std::vector<int32_t>& values, uint8_t for_kind,
+                         uint8_t dict_kind) {
+        std::vector<int32_t> dict(values);
+        std::sort(dict.begin(), dict.end());
+        dict.erase(std::unique(dict.begin(), dict.end()), dict.end());
+        const int32_t lo = dict.empty() ? 0 : dict.front();
+        const uint32_t span = dict.empty() ? 0 : (uint32_t)((int64_t)dict.back() - lo);
+        const int n = (int)values.size();
+        const int for_bits = bitWidth(span);
+        const int dict_bits = bitWidth(dict.empty() ? 0 : (uint32_t)(dict.size() - 1));
+
+        std::vector<uint32_t> codes(values.size());
+        if (dict.size() * sizeof(int32_t) + packedBytes(n, dict_bits) < packedBytes(n, for_bits)) {
+            appendColumnHeader(out, dict_kind, dict_bits, dict.size(), 0, (uint32_t)(dict.size() - 1));
+            for (int32_t v : dict) append<int32_t>(out, v);
+            for (int i = 0; i < n; ++i)
+                codes[i] = (uint32_t)(std::lower_bound(dict.begin(), dict.end(), values[i]) - dict.begin());
+            appendPacked(out, codes, dict_bits);
+            return;
+        }
+        appendColumnHeader(out, for_kind, for_bits, 0, lo, span);
+        for (int i = 0; i < n; ++i) codes[i] = (uint32_t)((int64_t)values[i] - lo);
+        appendPacked(out, codes, for_bits);
+    }
+
+    // Thousandths when every value comes back bit for bit, raw floats otherwise
+    void appendFloatColumn(std::vector<char>& out, const std::vector<float>& values, uint8_t fixed_kind,
+                           uint8_t raw_kind) {
+        std::vector<int32_t> scaled(values.size());
+        bool exact = true;
+        for (size_t i = 0; i < values.size() && exact; ++i) {
+            const double q = std::nearbyint((double)values[i] * FIXED_POINT_SCALE);
+            exact = std::fabs(q) < (double)(1 << 30);
+            if (!exact) break;
+            scaled[i] = (int32_t)q;
+            const float back = (float)((double)scaled[i] / FIXED_POINT_SCALE);
+            exact = std::memcmp(&back, &values[i], sizeof(float)) == 0;
+        }
+        if (exact) {
+            const auto range = std::minmax_element(scaled.begin(), scaled.end());
+            const int32_t lo = scaled.empty() ? 0 : *range.first;
+            const uint32_t span = scaled.empty() ? 0 : (uint32_t)(*range.second - lo);
+            const int bits = bitWidth(span);
+            appendColumnHeader(out, fixed_kind, bits, 0, lo, span);
+            std::vector<uint32_t> codes(scaled.size());
+            for (size_t i = 0; i < scaled.size(); ++i) codes[i] = (uint32_t)(scaled[i] - lo);
+            appendPacked(out, codes, bits);
+            return;
+        }
+        appendColumnHeader(out, raw_kind, 0, values.size(), 0, 0);
+        for (float v : values) append<float>(out, v);
+    }
+
+    // One loop per code width, so the shifts and masks are constants the
+    // compiler can unroll around
+    template<int Bits>
+    void unpackBits(const char* packed, int count, uint32_t* codes) {
+        const uint64_t mask = (1ULL << Bits) - 1;
+        for (int r = 0; r < count; ++r) {
+            const size_t bit = (size_t)r * Bits;
+            codes[r] = (uint32_t)((load<uint64_t>(packed + bit / 8) >> (bit % 8)) & mask);
+        }
+    }
+
+    template<>
+    void unpackBits<0>(const char*, int count, uint32_t* codes) {
+        std::fill(codes, codes + count, 0u);
+    }
+
+    typedef void (*UnpackFn)(const char*, int, uint32_t*);
+
+#define UNPACK_ROW(b) unpackBits<b>, unpackBits<b + 1>, unpackBits<b + 2>, unpackBits<b + 3>
+#define UNPACK_TABLE                                                                                 \
+    { UNPACK_ROW(0), UNPACK_ROW(4), UNPACK_ROW(8), UNPACK_ROW(12), UNPACK_ROW(16), UNPACK_ROW(20), \
+      UNPACK_ROW(24), UNPACK_ROW(28), unpackBits<32> }
+
+    int liveRows(const uint64_t bitmap[Block::SLOT_WORDS]) {
+        int rows = 0;
+        for (int w = 0; w < Block::SLOT_WORDS; w++) rows += (int)std::bitset<64>(bitmap[w]).count();
+        return rows;
+    }
+
+    int32_t clampToInt32(double v) {
+        if (v <= (double)std::numeric_limits<int32_t>::min()) return std::numeric_limits<int32_t>::min();
+        if (v >= (double)std::numeric_limits<int32_t>::max()) return std::numeric_limits<int32_t>::max();
+        return (int32_t)v;
+    }
+}
+
+// =============================
+// Encoding
+// =============================
+void EncodedBlock::encode(const Block& block, std::vector<char>& out)
+{
+    const int n = block.record_count;
+    const size_t start = out.size();
+    append<uint16_t>(out, (uint16_t)n);
+    append<uint8_t>(out, (uint8_t)block.layout);
+    append<uint8_t>(out, 0);
+    out.resize(out.size() + 2 * GAME_COLUMN_COUNT, 0);
+
+    for (int c = 0; c < GAME_COLUMN_COUNT; ++c) {
+        const GameColumn col = (GameColumn)c;
+        const ColumnView view = block.column(col);
+        const uint16_t offset = (uint16_t)(out.size() - start);
+        std::memcpy(out.data() + start + 4 + 2 * c, &offset, sizeof(offset));
+        if (Block::columnIsFloat(col)) {
+            std::vector<float> values(n);
+            for (int r = 0; r < n; ++r) values[r] = view.get<float>(r);
+            appendFloatColumn(out, values, FixedPoint, RawFloat);
+            continue;
+        }
+        std::vector<int32_t> values(n);
+        for (int r = 0; r < n; ++r)
+            values[r] = col == GameColumn::HomeTeamWins ? (view.at(r)[0] ? 1 : 0) : view.get<int32_t>(r);
+        appendIntColumn(out, values, FrameOfReference, Dictionary);
+    }
+    out.resize(out.size() + CODE_SLACK, 0);
+}
+
+// =============================
+// Reading
+// =============================
+EncodedBlock::EncodedBlock(const char* data, size_t size)
+    : data_(data), size_(size), record_count_(0), layout_(BlockLayout::Row), valid_(false)
+{
+    if (size < BLOCK_HEADER_BYTES + CODE_SLACK) return;
+    const int count = load<uint16_t>(data);
+    const uint8_t layout = (uint8_t)data[2];
+    if (count > Block::MAX_SLOTS || layout > (uint8_t)BlockLayout::Pax) return;
+    for (int c = 0; c < GAME_COLUMN_COUNT; ++c) {
+        const size_t offset = load<uint16_t>(data + 4 + 2 * c);
+        if (offset < BLOCK_HEADER_BYTES || offset + COLUMN_HEADER_BYTES > size - CODE_SLACK) return;
+    }
+    layout_ = (BlockLayout)layout;
+    record_count_ = count;
+    valid_ = true;
+}
+
+bool EncodedBlock::column(GameColumn col, Column& c) const
+{
+    if (!valid_) return false;
+    const char* p = data_ + load<uint16_t>(data_ + 4 + 2 * (int)col);
+    c.kind = (Kind)(uint8_t)p[0];
+    c.bits = (uint8_t)p[1];
+    const size_t value_count = load<uint16_t>(p + 2);
+    c.base = load<int32_t>(p + 4);
+    c.max_code = load<uint32_t>(p + 8);
+    p += COLUMN_HEADER_BYTES;
+
+    const bool kind_ok = Block::columnIsFloat(col) ? (c.kind == FixedPoint || c.kind == RawFloat)
+                                                   : (c.kind == FrameOfReference || c.kind == Dictionary);
+    if (!kind_ok || c.bits > 32 || (c.bits < 32 && (uint64_t)c.max_code >> c.bits)) return false;
+    if (c.kind == Dictionary && value_count != (size_t)c.max_code + 1) return false;
+    if (c.kind == RawFloat && (value_count != (size_t)record_count_ || c.bits != 0)) return false;
+    if (c.kind != Dictionary && c.kind != RawFloat && value_count != 0) return false;
+
+    const size_t bytes = value_count * sizeof(int32_t) + packedBytes(record_count_, c.bits);
+    if ((size_t)(data_ + size_ - CODE_SLACK - p) < bytes) return false;
+    c.values = p;
+    c.codes = p + value_count * sizeof(int32_t);
+    return true;
+}
+
+bool EncodedBlock::verify() const
+{
+    // A dictionary code past the last entry would read outside the block
+    uint32_t codes[Block::MAX_SLOTS];
+    for (int col = 0; col < GAME_COLUMN_COUNT; ++col) {
+        Column c;
+        if (!column((GameColumn)col, c)) return false;
+        if (c.kind != Dictionary) continue;
+        unpack(c, codes);
+        for (int r = 0; r < record_count_; ++r)
+            if (codes[r] > c.max_code) return false;
+    }
+    return true;
+}
+
+void EncodedBlock::unpack(const Column& c, uint32_t* codes) const
+{
+    static const UnpackFn table[] = UNPACK_TABLE;
+    table[c.bits](c.codes, record_count_, codes);
+}
+
+int32_t EncodedBlock::intValue(const Column& c, uint32_t code) const
+{
+    if (c.kind == Dictionary) return load<int32_t>(c.values + code * sizeof(int32_t));
+    return (int32_t)((int64_t)c.base + code);
+}
+
+float EncodedBlock::floatValue(const Column& c, uint32_t code) const
+{
+    return (float)((double)((int64_t)c.base + code) / FIXED_POINT_SCALE);
+}
+
+void EncodedBlock::decode(Block& block) const
+{
+    // Column at a time straight into the block's slots, like Block::addRecord
+    // would lay them out
+    block = Block(layout_);
+    const int n = record_count_;
+    uint32_t codes[Block::MAX_SLOTS];
+    for (int c = 0; c < GAME_COLUMN_COUNT; ++c) {
+        const GameColumn col = (GameColumn)c;
+        Column column;
+        if (!this->column(col, column)) {
+            block = Block(layout_);
+            return;
+        }
+        const ColumnView view = block.column(col);
+        char* dst = const_cast<char*>(view.base);
+        if (column.kind == RawFloat) {
+            for (int r = 0; r < n; ++r)
+                std::memcpy(dst + r * view.stride, column.values + r * sizeof(float), sizeof(float));
+            continue;
+        }
+        unpack(column, codes);
+        for (int r = 0; r < n; ++r) {
+            char* field = dst + r * view.stride;
+            if (column.kind == FixedPoint) {
+                const float v = floatValue(column, codes[r]);
+                std::memcpy(field, &v, sizeof(v));
+            } else if (col == GameColumn::HomeTeamWins) {
+                *reinterpret_cast<bool*>(field) = intValue(column, codes[r]) != 0;
+            } else {
+                const int32_t v = intValue(column, codes[r]);
+                std::memcpy(field, &v, sizeof(v));
+            }
+        }
+    }
+    block.record_count = n;
+    block.used_space = n * GameRecord::getRecordSize();
+}
+
+// =============================
+// Predicates on codes
+// =============================
+bool EncodedBlock::withinBound(GameColumn col, const Column& c, uint32_t code, const ScanPredicate& p,
+                               bool upper) const
+{
+    if (Block::columnIsFloat(col)) {
+        const float v = floatValue(c, code);
+        return upper ? v <= (float)p.hi : (float)p.lo <= v;
+    }
+    if (col == GameColumn::HomeTeamWins) {
+        const double v = intValue(c, code) ? 1.0 : 0.0;
+        return upper ? v <= p.hi : p.lo <= v;
+    }
+    const int32_t v = intValue(c, code);
+    return upper ? v <= clampToInt32(p.hi) : clampToInt32(p.lo) <= v;
+}
+
+int EncodedBlock::evaluate(const std::vector<ScanPredicate>& predicates, uint64_t bitmap[Block::SLOT_WORDS],
+                           Simd::Level level) const
+{
+    const int n = record_count_;
+    for (int w = 0; w < Block::SLOT_WORDS; w++) {
+        const int bits = std::min(64, std::max(0, n - 64 * w));
+        bitmap[w] = bits == 64 ? ~0ULL : ((1ULL << bits) - 1);
+    }
+
+    int live = n;
+    for (const auto& p : predicates) {
+        if (live == 0) break;
+        Column c;
+        if (!column(p.column, c)) {
+            std::fill(bitmap, bitmap + Block::SLOT_WORDS, 0);
+            return 0;
+        }
+        if (c.kind == RawFloat) {
+            alignas(32) float values[Block::MAX_SLOTS];
+            std::memcpy(values, c.values, n * sizeof(float));
+            Simd::andRangeMask(values, n, (float)p.lo, (float)p.hi, bitmap, level);
+            live = liveRows(bitmap);
+            continue;
+        }
+
+        // Codes are ordered like their values, so the predicate keeps the
+        // codes [lo_code, hi_code). FOR and fixed point codes are affine in
+        // the value: the bound gives the answer directly, checked against its
+        // neighbour; dictionaries (and a wrong guess) binary search 0..max_code
+        const int64_t code_count = (int64_t)c.max_code + 1;
+        auto firstCodeWhere = [&](bool upper) {
+            // Codes before the answer pass this test, the rest fail it
+            auto before = [&](int64_t k) { return withinBound(p.column, c, (uint32_t)k, p, upper) == upper; };
+            int64_t first = 0, count = code_count;
+            if (c.kind != Dictionary) {
+                const double bound = upper ? p.hi : p.lo;
+                double guess = c.kind == FixedPoint
+                                   ? (upper ? std::floor(bound * FIXED_POINT_SCALE) + 1 : std::ceil(bound * FIXED_POINT_SCALE))
+                                   : (double)clampToInt32(bound) + (upper ? 1 : 0);
+                guess = std::min(std::max(guess - c.base, 0.0), (double)code_count);
+                const int64_t g = (int64_t)guess;
+                const bool at_start = g == 0 || before(g - 1);
+                const bool at_end = g == code_count || !before(g);
+                if (at_start && at_end) return g;
+                if (at_start) first = g + 1, count = code_count - g - 1;
+                else count = g - 1;
+            }
+            while (count > 0) {
+                const int64_t half = count / 2;
+                if (before(first + half)) {
+                    first += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return first;
+        };
+        const int64_t lo_code = firstCodeWhere(false); // first code >= p.lo
+        const int64_t hi_code = firstCodeWhere(true);  // first code > p.hi
+        if (lo_code >= hi_code) {
+            std::fill(bitmap, bitmap + Block::SLOT_WORDS, 0);
+            return 0;
+        }
+        if (lo_code == 0 && hi_code == code_count) continue; // every row passes
+
+        alignas(32) uint32_t codes[Block::MAX_SLOTS];
+        unpack(c, codes);
+        if (c.bits < 32) {
+            Simd::andRangeMask(reinterpret_cast<const int32_t*>(codes), n, (int32_t)lo_code,
+                               (int32_t)(hi_code - 1), bitmap, level);
+        } else {
+            for (int r = 0; r < n; ++r)
+                if (codes[r] < lo_code || codes[r] >= hi_code) bitmap[r >> 6] &= ~(1ULL << (r & 63));
+        }
+        live = liveRows(bitmap);
+    }
+
+    return live;
+}
@@ -3,21 +3,67 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 // Forward declaration
 class DatabaseFile;
 
+// =============================
+// SIMD helpers (runtime dispatch)
+// =============================
+namespace Simd
+{
+    enum class Level
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+    Level detectLevel(); // best level supported by this CPU (checked once)
+    const char *levelName(Level level);
+    int countTrailingZeros(uint64_t mask); // mask != 0
+
+    // Writes the offset of every '\t' and '\n' in data[0, len) to out (room for
+    // len entries) in 64-byte strides and returns how many were found. Levels
+    // above what the CPU supports fall back to the best available one.
+    size_t findDelimiters(const char *data, size_t len, uint32_t *out, Level level = detectLevel());
+
+    // Predicate kernels: for i < count, clear bit i of mask (64 slots per word)
+    // unless lo <= values[i] <= hi. NaN never matches.
+    void andRangeMask(const int32_t *values, int count, int32_t lo, int32_t hi, uint64_t *mask,
+                      Level level = detectLevel());
+    void andRangeMask(const float *values, int count, float lo, float hi, uint64_t *mask,
+                      Level level = detectLevel());
+
+    // Sorted-key kernels for B+ tree nodes: the number of keys[0, n) that are
+    // < key (countLess) or <= key (countLessEqual). keys must be ascending.
+    int countLess(const int32_t *keys, int n, int32_t key, Level level = detectLevel());
+    int countLessEqual(const int32_t *keys, int n, int32_t key, Level level = detectLevel());
+    int countLess(const float *keys, int n, float key, Level level = detectLevel());
+    int countLessEqual(const float *keys, int n, float key, Level level = detectLevel());
+}
+
 // =============================
 // Record & Block (Task 1 base)
 // =============================
 struct GameRecord
 {
-    // 11 bytes for date + 1 byte for boolean = 12 bytes (divisible by 4)
-    char game_date[11];  // 11 bytes - "YYYY-MM-DD"
-    bool home_team_wins; // 1 byte - true/false instead of int
+    // Dates are parsed once at ingest; 8 x 4 bytes + 1 byte bool = 36 bytes with padding
+    int32_t game_date;   // 4 bytes - YYYYMMDD (Utils::parseDateKey), sorts chronologically
     int team_id_home;    // 4 bytes
     int pts_home;        // 4 bytes
     float fg_pct_home;   // 4 bytes
@@ -25,6 +71,7 @@ struct GameRecord
     float fg3_pct_home;  // 4 bytes
     int ast_home;        // 4 bytes
     int reb_home;        // 4 bytes
+    bool home_team_wins; // 1 byte - true/false instead of int
 
     GameRecord();
     GameRecord(const std::string &date, int team_id, int pts, float fg_pct,
@@ -34,51 +81,627 @@ struct GameRecord
     static size_t getRecordSize();
 };
 
+// GameRecord attributes, for column-wise access into a Block. The 4-byte
+// columns come first so their PAX minipages stay 4-byte aligned.
+enum class GameColumn
+{
+    TeamId,
+    Points,
+    FgPct,
+    FtPct,
+    Fg3Pct,
+    Assists,
+    Rebounds,
+    Date,
+    HomeTeamWins
+};
+static const int GAME_COLUMN_COUNT = 9;
+
+// Row: whole GameRecords back to back. PAX: the page is split into one
+// minipage per column, each holding that attribute for every slot.
+enum class BlockLayout : int32_t
+{
+    Row = 0,
+    Pax = 1
+};
+
+// One column of a block: value i lives at base + i * stride
+struct ColumnView
+{
+    const char *base;
+    size_t stride;
+
+    const char *at(int index) const { return base + index * stride; }
+    template <typename T>
+    T get(int index) const
+    {
+        T value;
+        std::memcpy(&value, at(index), sizeof(T));
+        return value;
+    }
+};
+
+// Inclusive range predicate lo <= column <= hi, with bounds already rounded to
+// the column's type (use the factories; +/-infinity means unbounded). A scan
+// takes a conjunction of these.
+struct ScanPredicate
+{
+    GameColumn column;
+    double lo;
+    double hi;
+
+    static ScanPredicate between(GameColumn col, double lo, double hi); // lo <= v <= hi
+    static ScanPredicate greaterThan(GameColumn col, double v);         // v' > v
+    static ScanPredicate atLeast(GameColumn col, double v);             // v' >= v
+    static ScanPredicate lessThan(GameColumn col, double v);            // v' < v
+    static ScanPredicate atMost(GameColumn col, double v);              // v' <= v
+    static ScanPredicate equals(GameColumn col, double v);
+};
+
 struct Block
 {
     static const size_t BLOCK_SIZE = 4096; // 4KB page
     char data[BLOCK_SIZE];
     size_t used_space;
     int record_count;
+    BlockLayout layout; // occupies what used to be tail padding
 
-    Block();
+    explicit Block(BlockLayout block_layout = BlockLayout::Row);
     bool addRecord(const GameRecord &record);
-    GameRecord getRecord(int index) const;
+    GameRecord getRecord(int index) const; // rebuilds the full row in either layout
     bool canFitRecord() const;
     static int getMaxRecordsPerBlock();
+
+    ColumnView column(GameColumn col) const;
+    template <typename T>
+    T getField(GameColumn col, int index) const { return column(col).get<T>(index); }
+
+    static size_t columnWidth(GameColumn col);
+    static size_t columnRecordOffset(GameColumn col); // offset inside GameRecord
+    static size_t paxMinipageOffset(GameColumn col);  // offset inside data[]
+    static bool columnIsFloat(GameColumn col);
+
+    // Selection bitmap over the slots of one block (bit r = slot r)
+    static const int MAX_SLOTS = BLOCK_SIZE / sizeof(GameRecord);
+    static const int SLOT_WORDS = (MAX_SLOTS + 63) / 64;
+
+    // Evaluates a conjunction of predicates over every slot with SIMD
+    // compare/mask kernels; fills bitmap and returns the number of matches.
+    // Date predicates compare YYYYMMDD values (Utils::parseDateKey).
+    int evaluate(const std::vector<ScanPredicate> &predicates, uint64_t bitmap[SLOT_WORDS],
+                 Simd::Level level = Simd::detectLevel()) const;
+
+    // Calls fn(slot) for every set bit, in slot order
+    template <typename Fn>
+    static void forEachSlot(const uint64_t bitmap[SLOT_WORDS], Fn fn)
+    {
+        for (int w = 0; w < SLOT_WORDS; w++)
+            for (uint64_t bits = bitmap[w]; bits; bits &= bits - 1)
+                fn(w * 64 + Simd::countTrailingZeros(bits));
+    }
+};
+
+// =============================
+// Zone maps (per-block min/max)
+// =============================
+// Smallest and largest value of every column over the records of one block,
+// dates as YYYYMMDD. A scan can skip the block when any predicate's range
+// misses [min, max]. A zone with no records has min > max and matches nothing.
+struct BlockZone
+{
+    double min[GAME_COLUMN_COUNT];
+    double max[GAME_COLUMN_COUNT];
+
+    BlockZone();
+    void include(const GameRecord &record);
+    bool mayMatch(const std::vector<ScanPredicate> &predicates) const;
+
+    // Column value as compared by predicates and zone maps (NaN if unparsable)
+    static double columnValue(const GameRecord &record, GameColumn col);
+};
+
+// =============================
+// Compressed blocks (lightweight encodings)
+// =============================
+// Format of the blocks DatabaseFile writes to disk. Compressed stores each
+// block column by column (GameColumn order), each column as fixed-width
+// bit-packed codes under the smallest fitting encoding:
+//   - frame of reference: value = base + code (int columns, the win flag)
+//   - dictionary: value = dict[code] over the block's sorted distinct values
+//     (int columns with few values far apart, e.g. dates across New Year)
+//   - fixed point: value = (base + code) / 1000, for percentages that
+//     round-trip through three decimals exactly
+//   - raw 4-byte floats, for any other float column
+enum class BlockEncoding : int32_t
+{
+    Raw = 0,
+    Compressed = 1
+};
+
+// Read-only view of one compressed block. Codes order like the values they
+// stand for in every encoding, so a range predicate maps to one code range
+// per column and evaluate() filters the packed codes without decoding a row.
+class EncodedBlock
+{
+public:
+    // Appends the encoding of block to out
+    static void encode(const Block &block, std::vector<char> &out);
+
+    // Reads the header of the block in data[0, size), which must outlive
+    // the view; columns are parsed when used. isValid() is false if the
+    // header is truncated or corrupt; verify() also parses every column and
+    // checks every dictionary code, which reading a file does once per
+    // block so scans of the kept bytes need not
+    EncodedBlock(const char *data, size_t size);
+    bool isValid() const { return valid_; }
+    bool verify() const;
+    int recordCount() const { return record_count_; }
+
+    // Rebuilds the block, in the layout it was encoded from
+    void decode(Block &block) const;
+    // Same bitmap and match count as Block::evaluate() on the decoded block
+    int evaluate(const std::vector<ScanPredicate> &predicates, uint64_t bitmap[Block::SLOT_WORDS],
+                 Simd::Level level = Simd::detectLevel()) const;
+
+private:
+    enum Kind : uint8_t
+    {
+        FrameOfReference = 0,
+        Dictionary = 1,
+        FixedPoint = 2,
+        RawFloat = 3
+    };
+    struct Column
+    {
+        Kind kind;
+        int bits;           // code width, 0..32
+        uint32_t max_code;  // codes are 0..max_code
+        int32_t base;       // frame of reference / fixed point
+        const char *values; // dictionary entries or raw floats
+        const char *codes;  // bit-packed codes, row order
+    };
+
+    const char *data_;
+    size_t size_;
+    int record_count_;
+    BlockLayout layout_;
+    bool valid_;
+
+    // Parses the header of column col; false if it does not fit the block
+    bool column(GameColumn col, Column &c) const;
+    // The record_count_ codes of c, in row order
+    void unpack(const Column &c, uint32_t *codes) const;
+    int32_t intValue(const Column &c, uint32_t code) const;
+    float floatValue(const Column &c, uint32_t code) const;
+    // Whether the value behind code is >= p.lo (upper false) or <= p.hi
+    // (upper true), compared as Block::evaluate() compares the column
+    bool withinBound(GameColumn col, const Column &c, uint32_t code, const ScanPredicate &p, bool upper) const;
+};
+
+// =============================
+// Posting lists (duplicate keys)
+// =============================
+// Heap location of one record, packed into one 64-bit locator: block ID in
+// the high half, slot in the low half, so (block, slot) order is integer order
+struct RID
+{
+    uint64_t locator;
+
+    static RID at(int32_t block_id, int32_t record_id)
+    {
+        return RID{(uint64_t)(uint32_t)block_id << 32 | (uint32_t)record_id};
+    }
+    int32_t blockId() const { return (int32_t)(locator >> 32); }
+    int32_t recordId() const { return (int32_t)(uint32_t)locator; }
+
+    bool operator<(const RID &o) const { return locator < o.locator; }
+    bool operator==(const RID &o) const { return locator == o.locator; }
+};
+
+// One 4KB overflow page of a posting list: a sorted run of RIDs
+struct PostingPage
+{
+    static const int CAPACITY = 510; // count + next + rids fill the page
+    int32_t count;
+    PostingPage *next;
+    RID rids[CAPACITY];
+};
+
+// Overflow pages of one tree's posting lists, carved out of slabs of
+// SLAB_PAGES pages. Released pages are kept on a free list (linked through
+// next) for reuse; clear() frees whole slabs. Pages never move.
+class PageArena
+{
+public:
+    static const size_t SLAB_PAGES = 64;
+
+    PageArena() : used_(SLAB_PAGES), free_(nullptr), live_(0) {}
+    PageArena(PageArena &&other);
+    PageArena &operator=(PageArena &&other);
+
+    PostingPage *allocate(); // uninitialized
+    void release(PostingPage *page);
+    void clear();
+    size_t livePages() const { return live_; }
+
+private:
+    std::vector<std::unique_ptr<PostingPage[]>> slabs_;
+    size_t used_; // pages handed out of the last slab
+    PostingPage *free_;
+    size_t live_;
+};
+
+// Sorted RIDs of one distinct key in a B+ tree leaf. Up to INLINE_RIDS live
+// in the leaf slot itself; longer lists move to a chain of overflow pages,
+// each holding a contiguous sorted run. Plain data: pages come from and go
+// back to the tree's PageArena, and slots are moved by copying.
+struct PostingList
+{
+    static const int INLINE_RIDS = 16; // a full leaf still fits one index page
+    int32_t count;
+    union
+    {
+        RID inline_rids[INLINE_RIDS];
+        PostingPage *overflow; // count > INLINE_RIDS
+    };
+
+    bool isOverflow() const { return count > INLINE_RIDS; }
+    size_t pageCount() const;           // overflow pages in the chain
+    void assign(const RID *rids, int n, PageArena &pages); // rids sorted
+    void insert(RID rid, PageArena &pages);                // keeps the list sorted
+    bool erase(RID rid, PageArena &pages);                 // false if rid is not in the list
+    void clear(PageArena &pages);                          // releases overflow pages
+
+    // Calls fn(rid) in RID order
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        if (!isOverflow())
+        {
+            for (int i = 0; i < count; i++)
+                fn(inline_rids[i]);
+            return;
+        }
+        for (const PostingPage *p = overflow; p; p = p->next)
+            for (int i = 0; i < p->count; i++)
+                fn(p->rids[i]);
+    }
+    void appendTo(std::vector<std::pair<int, int>> &out) const;
 };
 
+// =============================
+// Composite (multi-column) keys
+// =============================
+// Two columns ordered lexicographically, first column first. Every key with
+// the same first value is contiguous in the leaves, so a prefix lookup (first
+// column only) or a range of the second column under one first value is a
+// single descent plus one leaf sweep. Columns that are only read, never
+// searched, can ride along as a trailing component (a covering index).
+template <typename KeyType>
+struct KeyLimits
+{
+    static KeyType lowest() { return std::numeric_limits<KeyType>::lowest(); }
+    static KeyType max() { return std::numeric_limits<KeyType>::max(); }
+};
+
+template <typename First, typename Second>
+struct CompositeKey
+{
+    First first;
+    Second second;
+
+    bool operator<(const CompositeKey &o) const
+    {
+        return first < o.first || (!(o.first < first) && second < o.second);
+    }
+    bool operator==(const CompositeKey &o) const { return first == o.first && second == o.second; }
+
+    // Smallest and largest key with first column f, bounding a prefix lookup
+    static CompositeKey prefixLow(const First &f) { return {f, KeyLimits<Second>::lowest()}; }
+    static CompositeKey prefixHigh(const First &f) { return {f, KeyLimits<Second>::max()}; }
+};
+
+template <typename First, typename Second>
+struct KeyLimits<CompositeKey<First, Second>>
+{
+    static CompositeKey<First, Second> lowest() { return {KeyLimits<First>::lowest(), KeyLimits<Second>::lowest()}; }
+    static CompositeKey<First, Second> max() { return {KeyLimits<First>::max(), KeyLimits<Second>::max()}; }
+};
+
+template <typename First, typename Second>
+std::ostream &operator<<(std::ostream &os, const CompositeKey<First, Second> &k)
+{
+    return os << "(" << k.first << ", " << k.second << ")";
+}
+
+// (TEAM_ID_home, GAME_DATE as YYYYMMDD)
+typedef CompositeKey<int, int> TeamDateKey;
+// FT_PCT_home, carrying PTS_home and HOME_TEAM_WINS for index-only aggregates
+typedef CompositeKey<float, CompositeKey<int, bool>> FTCoveringKey;
+
+// =============================
+// Day codes (date index keys)
+// =============================
+// Order-preserving dictionary from calendar dates to dense 16-bit codes:
+// code 0 stands for "no date" (YYYYMMDD 0) and code n for the n-th day
+// counting 1900-01-01 as day 1, so consecutive days get consecutive codes up
+// to 2079-06-05. Codes compare exactly as their YYYYMMDD keys do, at half the
+// width, and need no table: the mapping is calendar arithmetic.
+struct DayCode
+{
+    uint16_t code;
+
+    // YYYYMMDD -> code; 0 unless key is a calendar date the codes reach
+    static DayCode fromDateKey(int key);
+    // Codes of the first and last dates the codes reach in [first_key,
+    // last_key], which may be any ints (not only calendar dates). An empty
+    // range comes back as last < first, which every index sweep skips.
+    static void range(int first_key, int last_key, DayCode &first, DayCode &last);
+    // code -> YYYYMMDD (0 for code 0)
+    int toDateKey() const;
+
+    bool operator<(const DayCode &o) const { return code < o.code; }
+    bool operator==(const DayCode &o) const { return code == o.code; }
+};
+
+// Printed as its YYYYMMDD key
+std::ostream &operator<<(std::ostream &os, const DayCode &d);
+
+// =============================
+// Intra-node key search
+// =============================
+// Position of key among the ascending keys[0, n) of one node: lowerBound is
+// the number of keys < key (its slot in a leaf), upperBound the number of
+// keys <= key (the child to follow). int, float and DayCode keys use the
+// branchless binary search; other key types keep the branching std:: search,
+// since with out-of-line compares (std::string) a cmov chain loses to
+// speculation.
+template <typename KeyType>
+struct KeySearch
+{
+    static int lowerBound(const KeyType *keys, int n, const KeyType &key)
+    {
+        return (int)(std::lower_bound(keys, keys + n, key) - keys);
+    }
+    static int upperBound(const KeyType *keys, int n, const KeyType &key)
+    {
+        return (int)(std::upper_bound(keys, keys + n, key) - keys);
+    }
+
+    // Halves the window without branching on the comparison (compiles to cmov)
+    static int binaryLowerBound(const KeyType *keys, int n, const KeyType &key)
+    {
+        if (n == 0)
+            return 0;
+        const KeyType *base = keys;
+        while (n > 1)
+        {
+            const int half = n / 2;
+            base = base[half] < key ? base + half : base;
+            n -= half;
+        }
+        return (int)(base - keys) + (*base < key ? 1 : 0);
+    }
+
+    static int binaryUpperBound(const KeyType *keys, int n, const KeyType &key)
+    {
+        if (n == 0)
+            return 0;
+        const KeyType *base = keys;
+        while (n > 1)
+        {
+            const int half = n / 2;
+            base = key < base[half] ? base : base + half;
+            n -= half;
+        }
+        return (int)(base - keys) + (key < *base ? 0 : 1);
+    }
+
+    // The original scan, kept as the benchmark baseline
+    static int linearUpperBound(const KeyType *keys, int n, const KeyType &key)
+    {
+        int pos = 0;
+        while (pos < n && !(key < keys[pos]))
+            pos++;
+        return pos;
+    }
+};
+
+template <>
+inline int KeySearch<int>::lowerBound(const int *keys, int n, const int &key) { return binaryLowerBound(keys, n, key); }
+template <>
+inline int KeySearch<int>::upperBound(const int *keys, int n, const int &key) { return binaryUpperBound(keys, n, key); }
+template <>
+inline int KeySearch<float>::lowerBound(const float *keys, int n, const float &key) { return binaryLowerBound(keys, n, key); }
+template <>
+inline int KeySearch<float>::upperBound(const float *keys, int n, const float &key) { return binaryUpperBound(keys, n, key); }
+template <>
+inline int KeySearch<DayCode>::lowerBound(const DayCode *keys, int n, const DayCode &key) { return binaryLowerBound(keys, n, key); }
+template <>
+inline int KeySearch<DayCode>::upperBound(const DayCode *keys, int n, const DayCode &key) { return binaryUpperBound(keys, n, key); }
+
 // =============================
 // B+ Tree node (fixed arrays)
 // =============================
+// Default fanout for a key type: the most keys for which a whole node fits
+// one 4KB index page (IndexManager::INDEX_PAGE_SIZE). Leaf slots dominate: a
+// key plus its inline posting list; the rest is key_count and next_leaf.
 template <typename KeyType>
+struct IndexFanout
+{
+    static const size_t PAGE_BYTES = 4096;
+    static const int value = (int)((PAGE_BYTES - 2 * sizeof(int32_t)) / (sizeof(KeyType) + sizeof(PostingList)));
+};
+
+// 32-bit reference to a node of one tree (see NodeArena); 0 is no node.
+// The top bit tells the two node kinds apart: set for leaves, clear for
+// internal nodes, each kind numbered in its own arena.
+typedef uint32_t NodeHandle;
+const NodeHandle NULL_NODE = 0;
+const NodeHandle LEAF_HANDLE_BIT = 0x80000000u;
+
+// Header shared by both node kinds: the key count and the sorted keys, which
+// a descent or a leaf sweep reads as one contiguous array.
+// Keys are distinct; separator i of an internal node is the smallest key in
+// children[i + 1] when built, so a key equal to a separator lives to its
+// right. Deletes may leave a separator whose key is gone: it then only bounds
+// the subtrees (children[i] < keys[i] <= children[i + 1]).
+// Fanout (keys per node) is fixed at compile time; trees of other fanouts
+// than the default must be instantiated in IndexManager.cpp. Nodes live in
+// their tree's arenas and are never destroyed one by one.
+template <typename KeyType, int Fanout = IndexFanout<KeyType>::value>
 struct BPlusTreeNode
 {
-    static const int MAX_KEYS = 20; // matches your stats print
+    static_assert(Fanout >= 3, "a B+ tree node needs at least 3 keys");
+    static const int MAX_KEYS = Fanout;
     static const int MIN_KEYS = MAX_KEYS / 2;
 
-    bool is_leaf;
-    int key_count;
+    int32_t key_count;
     KeyType keys[MAX_KEYS];
 
-    union
+    BPlusTreeNode();
+
+    bool isFull() const { return key_count >= MAX_KEYS; }
+    bool isUnderflow() const { return key_count < MIN_KEYS; }
+    // Child to follow for key: the number of separators <= key
+    int childIndex(const KeyType &key) const { return KeySearch<KeyType>::upperBound(keys, key_count, key); }
+    // Slot of key in a leaf (or where it would be inserted): the number of keys < key
+    int keyIndex(const KeyType &key) const { return KeySearch<KeyType>::lowerBound(keys, key_count, key); }
+};
+
+// Leaf: postings[i] holds every RID with key keys[i]; about one index page
+template <typename KeyType, int Fanout = IndexFanout<KeyType>::value>
+struct BPlusTreeLeaf : BPlusTreeNode<KeyType, Fanout>
+{
+    PostingList postings[Fanout];
+    NodeHandle next_leaf;
+
+    BPlusTreeLeaf();
+};
+
+// Internal node: keys plus child handles, a few hundred bytes at the default
+// fanouts, so the upper levels of a tree share a handful of cache lines
+template <typename KeyType, int Fanout = IndexFanout<KeyType>::value>
+struct BPlusTreeInternal : BPlusTreeNode<KeyType, Fanout>
+{
+    NodeHandle children[Fanout + 1];
+
+    BPlusTreeInternal();
+};
+
+// =============================
+// Node arenas
+// =============================
+// Nodes of one tree, carved out of slabs of SLAB_NODES consecutive nodes and
+// addressed by 32-bit handles (slab, slot). Nodes allocated one after the
+// other, such as the leaves of a bulk load or the halves of a split, are
+// neighbours in memory. Released nodes are reused through a free list; no
+// node is ever destroyed, so clear() frees a handful of slabs whatever the
+// tree size. Node addresses stay valid until the node is released.
+template <typename Node>
+class NodeArena
+{
+    static_assert(std::is_trivially_destructible<Node>::value, "arena nodes are freed without destructors");
+
+public:
+    static const int SLAB_SHIFT = 6;
+    static const NodeHandle SLAB_NODES = 1u << SLAB_SHIFT;
+
+    NodeArena() : next_(1) {} // slot 0 of the first slab stands for NULL_NODE
+
+    template <typename... Args>
+    NodeHandle allocate(Args &&...args)
     {
-        // Internal nodes
-        BPlusTreeNode<KeyType> *children[MAX_KEYS + 1];
-        // Leaf nodes
-        struct
+        NodeHandle h;
+        if (!free_.empty())
         {
-            int block_ids[MAX_KEYS];
-            int record_ids[MAX_KEYS];
-            BPlusTreeNode<KeyType> *next_leaf;
-        } leaf_data;
-    };
+            h = free_.back();
+            free_.pop_back();
+        }
+        else
+        {
+            h = next_++;
+            if ((h >> SLAB_SHIFT) == slabs_.size())
+                slabs_.emplace_back(new Slot[SLAB_NODES]);
+        }
+        new (&slot(h)) Node(std::forward<Args>(args)...);
+        return h;
+    }
+    void release(NodeHandle h) { free_.push_back(h); }
+    void clear()
+    {
+        slabs_.clear();
+        free_.clear();
+        next_ = 1;
+    }
 
-    BPlusTreeNode(bool leaf = true);
-    ~BPlusTreeNode();
+    Node &operator[](NodeHandle h) { return reinterpret_cast<Node &>(slot(h)); }
+    const Node &operator[](NodeHandle h) const { return reinterpret_cast<const Node &>(slabs_[h >> SLAB_SHIFT][h & (SLAB_NODES - 1)]); }
 
-    bool isFull() const { return key_count >= MAX_KEYS; }
-    bool isUnderflow() const { return key_count < MIN_KEYS; }
+    size_t liveNodes() const { return next_ - 1 - free_.size(); }
+    size_t reservedBytes() const { return slabs_.size() * SLAB_NODES * sizeof(Node); }
+
+private:
+    typedef typename std::aligned_storage<sizeof(Node), alignof(Node)>::type Slot;
+    Slot &slot(NodeHandle h) { return slabs_[h >> SLAB_SHIFT][h & (SLAB_NODES - 1)]; }
+
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    std::vector<NodeHandle> free_;
+    NodeHandle next_; // first handle never handed out
+};
+
+// One B+ tree: its root and the arenas owning its leaves, internal nodes and
+// overflow pages. Movable, not copyable; destroying or clearing it frees
+// slabs, not nodes.
+template <typename KeyType, int Fanout = IndexFanout<KeyType>::value>
+struct BPlusTree
+{
+    typedef BPlusTreeNode<KeyType, Fanout> Node;
+    typedef BPlusTreeLeaf<KeyType, Fanout> Leaf;
+    typedef BPlusTreeInternal<KeyType, Fanout> Internal;
+
+    NodeArena<Leaf> leaves;
+    NodeArena<Internal> internals;
+    PageArena pages;
+    NodeHandle root = NULL_NODE; // NULL_NODE until built or loaded
+
+    static bool isLeaf(NodeHandle h) { return (h & LEAF_HANDLE_BIT) != 0; }
+    NodeHandle newLeaf() { return leaves.allocate() | LEAF_HANDLE_BIT; }
+    NodeHandle newInternal() { return internals.allocate(); }
+    void release(NodeHandle h)
+    {
+        if (isLeaf(h))
+            leaves.release(h & ~LEAF_HANDLE_BIT);
+        else
+            internals.release(h);
+    }
+
+    Leaf &leaf(NodeHandle h) { return leaves[h & ~LEAF_HANDLE_BIT]; }
+    const Leaf &leaf(NodeHandle h) const { return leaves[h & ~LEAF_HANDLE_BIT]; }
+    Internal &internal(NodeHandle h) { return internals[h]; }
+    const Internal &internal(NodeHandle h) const { return internals[h]; }
+    // Key count and keys of either kind
+    Node &node(NodeHandle h) { return isLeaf(h) ? static_cast<Node &>(leaf(h)) : internal(h); }
+    const Node &node(NodeHandle h) const { return isLeaf(h) ? static_cast<const Node &>(leaf(h)) : internal(h); }
+
+    size_t liveNodes() const { return leaves.liveNodes() + internals.liveNodes(); }
+    size_t nodeBytes() const { return leaves.liveNodes() * sizeof(Leaf) + internals.liveNodes() * sizeof(Internal); }
+    void clear()
+    {
+        leaves.clear();
+        internals.clear();
+        pages.clear();
+        root = NULL_NODE;
+    }
+};
+
+// (key, block_id, record_id) tuple fed to the bulk loader
+template <typename KeyType>
+struct IndexEntry
+{
+    KeyType key;
+    int block_id;
+    int record_id;
 };
 
 // ======================================================
@@ -88,11 +711,49 @@ struct DeletionStats
 {
     uint32_t nInternal = 0; // internal B+ nodes visited (indexed path)
     uint32_t nLeaf = 0;     // leaf B+ nodes visited (indexed path)
-    uint32_t nOverflow = 0; // kept for symmetry; not used here
+    uint32_t nOverflow = 0; // posting-list overflow pages read (indexed path)
     uint32_t nData = 0;     // distinct data blocks touched
     uint32_t nDeleted = 0;  // records deleted
     double sumFT = 0.0;     // sum of FT% for deleted set (to average)
     long long timeUs = 0;   // wallclock microseconds
+
+    // Adds a per-thread partial result (timeUs is wall time, measured once)
+    void merge(const DeletionStats &other)
+    {
+        nInternal += other.nInternal;
+        nLeaf += other.nLeaf;
+        nOverflow += other.nOverflow;
+        nData += other.nData;
+        nDeleted += other.nDeleted;
+        sumFT += other.sumFT;
+    }
+};
+
+// Pull-based stream of (block_id, record_id) over one index key range. The
+// leaf chain is followed lazily, so holding a cursor costs a few pointers
+// whatever the range. Valid until the index it reads is modified.
+class RidCursor
+{
+public:
+    virtual ~RidCursor() {}
+    // Writes up to max RIDs (in key order) to out; 0 once exhausted
+    virtual size_t next(std::pair<int, int> *out, size_t max) = 0;
+};
+
+// Aggregates over an FT% range: index-only from the covering FT index, or
+// from the plain FT index plus one heap fetch per matching record
+struct CoveredStats
+{
+    uint64_t rows = 0;
+    int64_t sumPts = 0;
+    uint64_t wins = 0;      // home_team_wins
+    uint32_t nInternal = 0; // internal B+ nodes visited
+    uint32_t nLeaf = 0;     // leaf B+ nodes visited
+    uint32_t nOverflow = 0; // posting-list overflow pages read
+    uint32_t nData = 0;     // distinct data blocks read (0 when index-only)
+    long long timeUs = 0;   // wallclock microseconds
+
+    double avgPts() const { return rows ? (double)sumPts / rows : 0.0; }
 };
 
 // =============================
@@ -101,68 +762,457 @@ struct DeletionStats
 class IndexManager
 {
 private:
-    BPlusTreeNode<int> *team_id_index;      // TEAM_ID_home
-    BPlusTreeNode<int> *points_index;       // PTS_home
-    BPlusTreeNode<float> *fg_pct_index;     // FG_PCT_home
-    BPlusTreeNode<std::string> *date_index; // GAME_DATE
-    BPlusTreeNode<float> *ft_pct_index;     // FT_PCT_home
+    BPlusTree<int> team_id_index;      // TEAM_ID_home
+    BPlusTree<int> points_index;       // PTS_home
+    BPlusTree<float> fg_pct_index;     // FG_PCT_home
+    BPlusTree<DayCode> date_index;     // GAME_DATE as a day code
+    BPlusTree<float> ft_pct_index;     // FT_PCT_home
+    BPlusTree<TeamDateKey> team_date_index; // (TEAM_ID_home, GAME_DATE)
+    BPlusTree<FTCoveringKey> ft_cover_index; // FT_PCT_home + (PTS_home, HOME_TEAM_WINS)
 
 public:
-    IndexManager();
-    ~IndexManager();
+    IndexManager() {}
 
-    // Build full indexes (existing Task 2)
-    bool buildIndexes(const DatabaseFile &db);
+    // Build full indexes (existing Task 2). bulk_load sorts all entries once and
+    // packs the trees bottom-up, leaving each node fill_factor (0.5..1.0) full;
+    // otherwise every record goes through insert(). Tombstoned rows are left
+    // out, so index-only answers count the same rows as the heap.
+    bool buildIndexes(const DatabaseFile &db, bool bulk_load = true, float fill_factor = 1.0f);
 
     // Search (existing Task 2)
     std::vector<std::pair<int, int>> searchByTeamId(int team_id);
     std::vector<std::pair<int, int>> searchByPointsRange(int min_pts, int max_pts);
     std::vector<std::pair<int, int>> searchByFGPercentage(float min_pct, float max_pct);
     std::vector<std::pair<int, int>> searchByDate(const std::string &date);
+    // Dates as YYYYMMDD keys, both ends inclusive
+    std::vector<std::pair<int, int>> searchByDateRange(int first_key, int last_key);
     std::vector<std::pair<int, int>> searchByFTPercentage(float min_pct, float max_pct);
 
+    // Composite (team, date) index: one team's games between two YYYYMMDD
+    // keys (inclusive), or all of them (prefix lookup), in date order
+    std::vector<std::pair<int, int>> searchByTeamAndDateRange(int team_id, int first_key, int last_key);
+    std::vector<std::pair<int, int>> searchByTeamInDateOrder(int team_id);
+
+    // Streaming counterparts of the searches above: nothing is read until the
+    // cursor is pulled
+    std::unique_ptr<RidCursor> cursorByTeamId(int team_id) const;
+    std::unique_ptr<RidCursor> cursorByPointsRange(int min_pts, int max_pts) const;
+    std::unique_ptr<RidCursor> cursorByFGPercentage(float min_pct, float max_pct) const;
+    std::unique_ptr<RidCursor> cursorByFTPercentage(float min_pct, float max_pct) const;
+    std::unique_ptr<RidCursor> cursorByDateRange(int first_key, int last_key) const;
+    std::unique_ptr<RidCursor> cursorByTeamAndDateRange(int team_id, int first_key, int last_key) const;
+
+    // Index-only aggregate over min_pct <= FT% <= max_pct: points and wins
+    // come from the covering keys and row counts from the posting-list
+    // counts, so neither data blocks nor overflow pages are read
+    CoveredStats aggregateByFTPercentage(float min_pct, float max_pct) const;
+
     // Task 3: counts-aware FT% range scan
     std::vector<std::pair<int, int>>
     searchByFTPercentageWithCounts(float min_pct, float max_pct,
-                                   uint32_t &outInternal, uint32_t &outLeaf);
+                                   uint32_t &outInternal, uint32_t &outLeaf, uint32_t &outOverflow);
+
+    // Incremental maintenance: drops the record's RID from every index,
+    // removing keys whose posting list empties and rebalancing the trees
+    // (borrow from or merge with a sibling, shrink the root) on the way up.
+    // False if some index did not hold the RID.
+    bool removeRecord(const GameRecord &record, int block_id, int record_id);
+
+    // Structural check of every tree (key order, separator bounds, equal leaf
+    // depth, leaf chain, sorted non-empty postings); reports to std::cerr.
+    bool checkIntegrity() const;
 
     // Task 3: rebuild indexes skipping tombstoned rows
-    bool buildIndexesSkippingDeleted(const DatabaseFile &db);
+    bool buildIndexesSkippingDeleted(const DatabaseFile &db, bool bulk_load = true,
+                                     float fill_factor = 1.0f);
+
+    // Paged index files: each tree is written to <base_path>.<name>.idx as 4KB
+    // pages linked by page ID, and read back without touching the data blocks.
+    // Each file records the heap's record and block counts; loading fails
+    // unless they match, so indexes over other data are rebuilt instead.
+    static const size_t INDEX_PAGE_SIZE = 4096;
+    bool saveIndexes(const std::string &base_path, uint64_t record_count, uint64_t block_count) const;
+    bool loadIndexes(const std::string &base_path, uint64_t record_count, uint64_t block_count);
 
     // Stats (existing)
     void displayIndexStatistics() const;
+    bool hasIndexes() const { return team_id_index.root != NULL_NODE; } // built or loaded
+
+    // Standalone trees over caller-supplied entries, for fanout sweeps
+    // (Bench::fanout): instantiated for the default fanouts and for 8, 16,
+    // 32, 64, 128 and 256 keys per node.
+    template <typename KeyType, int Fanout>
+    BPlusTree<KeyType, Fanout> buildTree(std::vector<IndexEntry<KeyType>> entries, bool bulk_load);
+
+    template <typename KeyType, int Fanout>
+    const PostingList *findKey(const BPlusTree<KeyType, Fanout> &tree, const KeyType &key) const;
+
+    template <typename KeyType, int Fanout>
+    void treeShape(const BPlusTree<KeyType, Fanout> &tree, int &height, int &nodes) const;
 
 private:
     // Core B+ ops (existing)
-    template <typename KeyType>
-    bool insert(BPlusTreeNode<KeyType> *&root, KeyType key, int block_id, int record_id);
+    template <typename KeyType, int Fanout>
+    bool insert(BPlusTree<KeyType, Fanout> &tree, KeyType key, int block_id, int record_id);
+
+    template <typename KeyType, int Fanout>
+    bool remove(BPlusTree<KeyType, Fanout> &tree, const KeyType &key, int block_id, int record_id);
+
+    template <typename KeyType, int Fanout>
+    bool checkTree(const std::string &index_name, const BPlusTree<KeyType, Fanout> &tree) const;
+
+    template <typename KeyType, int Fanout>
+    std::vector<std::pair<int, int>> search(const BPlusTree<KeyType, Fanout> &tree, KeyType key);
+
+    template <typename KeyType, int Fanout>
+    std::vector<std::pair<int, int>> rangeSearch(const BPlusTree<KeyType, Fanout> &tree, KeyType min_key, KeyType max_key);
+
+    template <typename KeyType, int Fanout>
+    std::pair<KeyType, NodeHandle> splitLeaf(BPlusTree<KeyType, Fanout> &tree, NodeHandle leaf);
+
+    template <typename KeyType, int Fanout>
+    bool insertIntoLeaf(BPlusTree<KeyType, Fanout> &tree, NodeHandle leaf, KeyType key, int block_id, int record_id);
+
+    // Bottom-up construction from unsorted entries (sorted in place)
+    template <typename KeyType, int Fanout>
+    void bulkLoad(BPlusTree<KeyType, Fanout> &tree, std::vector<IndexEntry<KeyType>> &entries,
+                  float fill_factor);
+
+    bool buildAllIndexes(const DatabaseFile &db, bool skip_deleted, bool bulk_load,
+                         float fill_factor);
+
+    template <typename KeyType, int Fanout>
+    bool savePagedIndex(const std::string &path, const BPlusTree<KeyType, Fanout> &tree,
+                        uint64_t record_count, uint64_t block_count) const;
+
+    template <typename KeyType, int Fanout>
+    bool loadPagedIndex(const std::string &path, BPlusTree<KeyType, Fanout> &tree,
+                        uint64_t record_count, uint64_t block_count);
+
+    template <typename KeyType, int Fanout>
+    void displaySingleIndexStats(const std::string &index_name, const BPlusTree<KeyType, Fanout> &tree) const;
+
+    template <typename KeyType, int Fanout>
+    int countNodes(const BPlusTree<KeyType, Fanout> &tree) const;
+
+    template <typename KeyType, int Fanout>
+    int countLeafNodes(const BPlusTree<KeyType, Fanout> &tree) const;
+
+    template <typename KeyType, int Fanout>
+    int getTreeHeight(const BPlusTree<KeyType, Fanout> &tree) const;
+
+    template <typename KeyType, int Fanout>
+    int getTotalKeys(const BPlusTree<KeyType, Fanout> &tree) const;
+
+    // RIDs and overflow pages over all leaf postings
+    template <typename KeyType, int Fanout>
+    void countPostings(const BPlusTree<KeyType, Fanout> &tree, size_t &rids, size_t &pages) const;
+};
+
+// =============================
+// MappedFile (read-only mmap)
+// =============================
+// Whole-file read-only mapping (POSIX mmap / Win32 file mapping). Pages are
+// faulted in on first touch and shared through the OS page cache.
+class MappedFile
+{
+private:
+    const char *data_;
+    size_t size_;
+#ifdef _WIN32
+    void *file_handle_;
+    void *mapping_handle_;
+#else
+    int fd_;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+// =============================
+// Buffer pool (bounded block cache)
+// =============================
+// Eviction policy over frame slots. The pool reports every access and every
+// pin-count transition; the policy only ever picks among evictable frames.
+class EvictionPolicy
+{
+public:
+    virtual ~EvictionPolicy() {}
+    virtual const char *name() const = 0;
+    virtual void init(size_t frame_count) = 0;
+    virtual void recordAccess(size_t frame) = 0;
+    virtual void setEvictable(size_t frame, bool evictable) = 0;
+    virtual bool evict(size_t &frame) = 0; // chooses a victim and forgets it
+};
+
+// Second-chance CLOCK: one reference bit per frame and a sweeping hand
+class ClockPolicy : public EvictionPolicy
+{
+private:
+    std::vector<uint8_t> ref_bit;
+    std::vector<uint8_t> evictable;
+    size_t hand = 0;
+
+public:
+    const char *name() const override { return "CLOCK"; }
+    void init(size_t frame_count) override;
+    void recordAccess(size_t frame) override;
+    void setEvictable(size_t frame, bool is_evictable) override;
+    bool evict(size_t &frame) override;
+};
+
+// LRU-K: evicts the frame whose K-th most recent access is oldest; frames with
+// fewer than K accesses go first, oldest first access breaking ties
+class LRUKPolicy : public EvictionPolicy
+{
+private:
+    size_t k;
+    uint64_t clock_ = 0;
+    std::vector<std::vector<uint64_t>> history; // last K access times, oldest first
+    std::vector<uint8_t> evictable;
+
+public:
+    explicit LRUKPolicy(size_t k_value = 2) : k(k_value < 1 ? 1 : k_value) {}
+    const char *name() const override { return "LRU-K"; }
+    void init(size_t frame_count) override;
+    void recordAccess(size_t frame) override;
+    void setEvictable(size_t frame, bool is_evictable) override;
+    bool evict(size_t &frame) override;
+};
 
-    template <typename KeyType>
-    std::vector<std::pair<int, int>> search(BPlusTreeNode<KeyType> *root, KeyType key);
+struct BufferPoolStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0; // dirty frames written back to the file
+};
 
-    template <typename KeyType>
-    std::vector<std::pair<int, int>> rangeSearch(BPlusTreeNode<KeyType> *root, KeyType min_key, KeyType max_key);
+// Fixed number of Block frames in front of the database file. fetchBlock()
+// pins a block (reading it on a miss); every fetch must be matched by
+// unpinBlock(), passing dirty = true if the block was modified.
+class BufferPool
+{
+private:
+    struct Frame
+    {
+        Block block;
+        size_t block_id = 0;
+        int pin_count = 0;
+        bool dirty = false;
+        bool in_use = false;
+    };
 
-    template <typename KeyType>
-    std::pair<KeyType, BPlusTreeNode<KeyType> *> splitLeaf(BPlusTreeNode<KeyType> *leaf);
+    std::fstream file;
+    size_t data_offset; // bytes before block 0
+    std::vector<Frame> frames;
+    std::vector<size_t> free_frames;
+    std::unordered_map<size_t, size_t> page_table; // block_id -> frame
+    std::unique_ptr<EvictionPolicy> policy;
+    BufferPoolStats stats;
 
-    template <typename KeyType>
-    bool insertIntoLeaf(BPlusTreeNode<KeyType> *leaf, KeyType key, int block_id, int record_id);
+    bool claimFrame(size_t &frame);
+    bool readFrame(Frame &f);
+    bool writeFrame(Frame &f);
 
-    template <typename KeyType>
-    void displaySingleIndexStats(const std::string &index_name, BPlusTreeNode<KeyType> *root) const;
+public:
+    BufferPool(size_t frame_count, std::unique_ptr<EvictionPolicy> eviction_policy);
+    ~BufferPool();
 
-    template <typename KeyType>
-    int countNodes(BPlusTreeNode<KeyType> *root) const;
+    bool open(const std::string &path, size_t block_data_offset);
+    Block *fetchBlock(size_t block_id);
+    Block *newBlock(size_t block_id); // pinned, zeroed, dirty frame past EOF
+    void unpinBlock(size_t block_id, bool dirty);
+    bool flushAll();
 
-    template <typename KeyType>
-    int countLeafNodes(BPlusTreeNode<KeyType> *root) const;
+    size_t getFrameCount() const { return frames.size(); }
+    const char *getPolicyName() const { return policy->name(); }
+    const BufferPoolStats &getStats() const { return stats; }
+    void resetStats() { stats = BufferPoolStats(); }
+};
 
-    template <typename KeyType>
-    int getTreeHeight(BPlusTreeNode<KeyType> *root) const;
+// Read handle returned by DatabaseFile::getBlock(). In buffer-pool mode it
+// holds a pin that is released when the handle goes out of scope; in
+// compressed mode it owns the block decoded for it.
+class BlockRef
+{
+private:
+    const Block *block_;
+    BufferPool *pool_;
+    size_t block_id_;
+    std::unique_ptr<Block> decoded_;
 
-    template <typename KeyType>
-    int getTotalKeys(BPlusTreeNode<KeyType> *root) const;
+public:
+    explicit BlockRef(const Block *block, BufferPool *pool = nullptr, size_t block_id = 0)
+        : block_(block), pool_(pool), block_id_(block_id) {}
+    explicit BlockRef(std::unique_ptr<Block> decoded)
+        : block_(decoded.get()), pool_(nullptr), block_id_(0), decoded_(std::move(decoded)) {}
+    ~BlockRef()
+    {
+        if (pool_)
+            pool_->unpinBlock(block_id_, false);
+    }
+    BlockRef(BlockRef &&other)
+        : block_(other.block_), pool_(other.pool_), block_id_(other.block_id_), decoded_(std::move(other.decoded_))
+    {
+        other.pool_ = nullptr;
+    }
+    BlockRef(const BlockRef &) = delete;
+    BlockRef &operator=(const BlockRef &) = delete;
+
+    const Block &operator*() const { return *block_; }
+    const Block *operator->() const { return block_; }
+};
+
+// =============================
+// Write-ahead log (durable appends)
+// =============================
+struct WalStats
+{
+    uint64_t records = 0; // records made durable
+    uint64_t commits = 0; // group commits, one write + fsync each
+    uint64_t bytes = 0;   // bytes written to the log
+};
+
+// Append-only redo log of the records added after the last checkpoint.
+// Records are buffered and written as one frame per group commit, when
+// commit_batch of them are pending or on commit(). The log begins at record
+// number base() of the table, so replay can skip what the data file already
+// holds. A crash leaves whole frames plus at most one torn frame, which
+// open() cuts off.
+class WriteAheadLog
+{
+private:
+    std::FILE *file_;
+    uint64_t base_;
+    uint64_t records_;       // committed records
+    uint64_t size_;          // bytes of whole frames (and header) in the file
+    size_t commit_batch_;
+    std::vector<char> frame_; // pending frame: header + records
+    size_t pending_;
+    WalStats stats_;
+
+public:
+    static const char MAGIC[8];
+
+    explicit WriteAheadLog(size_t commit_batch);
+    ~WriteAheadLog(); // commits pending records
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    // Opens path for appending, creating it to begin at base if it is
+    // missing or empty. An existing log keeps its own base() and its records
+    // are returned in recovered. False on I/O errors or if path is not a log.
+    bool open(const std::string &path, uint64_t base, std::vector<GameRecord> &recovered);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+
+    bool append(const GameRecord &record); // commits once the batch is full
+    bool commit();                         // no-op without pending records
+    bool reset(uint64_t base);             // durably empties the log
+    void setCommitBatch(size_t records) { commit_batch_ = std::max<size_t>(1, records); }
+
+    uint64_t base() const { return base_; }
+    uint64_t records() const { return records_ + pending_; } // pending included
+    size_t pendingRecords() const { return pending_; }
+    const WalStats &getStats() const { return stats_; }
+
+    // fsync for a file written through another stream
+    static bool syncFile(const std::string &path);
+};
+
+// =============================
+// Thread pool (block-partitioned scans)
+// =============================
+// Runs parallelFor() jobs on a fixed set of threads; the calling thread takes
+// part as worker 0. [0, count) is split into one contiguous share per worker,
+// which each worker consumes `grain` items at a time. A worker that runs dry
+// steals the upper half of the largest remaining share, so ranges with uneven
+// cost (zone-map skips, tombstones) still finish together.
+class ThreadPool
+{
+public:
+    typedef std::function<void(unsigned worker, size_t begin, size_t end)> RangeFn;
+
+    explicit ThreadPool(unsigned thread_count = 0); // 0: one per hardware thread
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return (unsigned)shares.size(); }
+    // Returns once fn has run over every item exactly once. Not reentrant.
+    void parallelFor(size_t count, size_t grain, const RangeFn &fn);
+    uint64_t getSteals() const { return steals.load(); }
+
+private:
+    struct Share
+    {
+        std::mutex m;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Share>> shares; // one per worker, caller included
+    std::mutex m;
+    std::condition_variable wake, done;
+    const RangeFn *job = nullptr;
+    size_t job_grain = 1;
+    uint64_t generation = 0;
+    unsigned running = 0;
+    bool stopping = false;
+    std::atomic<uint64_t> steals{0};
+
+    void workerMain(unsigned worker);
+    void runShare(unsigned worker);
+    bool takeOwn(unsigned worker, size_t &begin, size_t &end);
+    bool steal(unsigned worker);
+};
+
+// =============================
+// Record cursor (streaming search results)
+// =============================
+// Materializes an index RID stream lazily: each refill pulls up to
+// BATCH_RIDS RIDs and reads them a block at a time (as fetchRecords_()
+// does for a whole result), so rows come out in block/slot order within a
+// batch and memory stays at one batch whatever the range. limit stops the
+// stream after that many rows (LIMIT). Move-only; invalidated, like the
+// underlying RidCursor, by changes to the indexes.
+class RecordCursor
+{
+public:
+    static const size_t BATCH_RIDS = 256;
+
+    RecordCursor() : db_(nullptr), limit_(0), returned_(0), pos_(0), block_reads_(0) {}
+    RecordCursor(const DatabaseFile *db, std::unique_ptr<RidCursor> rids,
+                 size_t limit = std::numeric_limits<size_t>::max());
+
+    bool next(GameRecord &out);                               // false at the end
+    size_t nextBatch(std::vector<GameRecord> &out, size_t n); // replaces out; 0 at the end
+    size_t blockReads() const { return block_reads_; }        // data block reads so far
+    size_t rowsReturned() const { return returned_; }
+
+private:
+    const DatabaseFile *db_;
+    std::unique_ptr<RidCursor> rids_;
+    size_t limit_;
+    size_t returned_;
+    std::vector<GameRecord> buffer_; // current batch
+    size_t pos_;                     // next row of buffer_
+    size_t block_reads_;
+
+    bool refill_();
 };
 
 // =============================
@@ -177,46 +1227,226 @@ private:
     size_t total_records;
     size_t total_blocks;
     IndexManager *index_manager;
+    BlockLayout block_layout;
 
-    // Task 3: in-memory tombstones (does NOT change on-disk layout)
+    // Mapped open mode: blocks stay in the file and getBlock() points into it
+    MappedFile mapped_file;
+    // Buffer-pool open mode: blocks are paged through a bounded set of frames
+    std::unique_ptr<BufferPool> buffer_pool;
+    // Compressed open mode: the file's encoded blocks stay in memory as read;
+    // block b is encoded_[encoded_offsets_[b], encoded_offsets_[b + 1])
+    std::vector<char> encoded_;
+    std::vector<uint64_t> encoded_offsets_;
+    BlockEncoding block_encoding;
+    EncodedBlock encodedBlock_(size_t block_id) const
+    {
+        return EncodedBlock(encoded_.data() + encoded_offsets_[block_id],
+                            encoded_offsets_[block_id + 1] - encoded_offsets_[block_id]);
+    }
+    bool writeCompressedBlocks_();
+    bool readCompressedBlocks_(std::istream &in, std::vector<char> &encoded, std::vector<uint64_t> &offsets);
+    void closeStorage_(); // leaves mapped, buffer-pool and compressed mode
+    bool writeHeaderInPlace_();
+
+    // Durable appends: <filename>.wal holds the records appended since the
+    // last checkpoint. Blocks [0, flushed_blocks_) are on disk exactly as in
+    // memory; 0 also covers files that are not a raw image of memory
+    // (never written, compressed), which a checkpoint rewrites whole.
+    std::unique_ptr<WriteAheadLog> wal_;
+    size_t commit_batch_;
+    size_t flushed_blocks_;
+    std::string logPath_() const { return filename + ".wal"; }
+    bool startLog_();
+    bool replayLog_();
+    bool restartLogAfterRewrite_();
+    bool flushDirtyBlocks_();
+    const Block *mappedBlocks() const
+    {
+        return reinterpret_cast<const Block *>(mapped_file.data() + FILE_HEADER_SIZE);
+    }
+
+    // Task 3: in-memory tombstones (does NOT change on-disk layout). Parallel
+    // passes give every block to exactly one worker and the bitmap is sized
+    // before they start, so markDeleted() needs no lock.
     std::vector<std::vector<uint8_t>> deleted_; // deleted_[block][slot] = 1
     void ensureDeletedBitmapInitialized_();
 
+    // Zone maps: zone_maps_[block], kept in step with the blocks and saved as
+    // <filename>.zmap. Tombstones do not shrink a zone (it stays a superset).
+    std::vector<BlockZone> zone_maps_;
+    bool use_zone_maps_;
+    void rebuildZoneMaps_();
+    bool writeZoneMapsToDisk_() const;
+    bool readZoneMapsFromDisk_();
+
+    // Block-partitioned passes: scan_threads_ workers (0 = one per hardware
+    // thread), pool created on first use. The buffer pool is single-threaded,
+    // so pool-mode passes run on the calling thread.
+    static const size_t SCAN_GRAIN = 16; // blocks per work item
+    unsigned scan_threads_;
+    mutable std::unique_ptr<ThreadPool> scan_pool_;
+    unsigned scanWorkers_() const;
+    void forEachBlockRange_(const ThreadPool::RangeFn &fn) const;
+
+    // Bitmap-heap-scan style fetch of index results: groups the (block, slot)
+    // locations by block (locations may be reordered), drops duplicates and
+    // out-of-range entries, then calls fn(block_id, block, slots, slot_count)
+    // once per block in block order with ascending slots, so each block is
+    // read (and pinned) once. Returns blocks visited.
+    typedef std::function<void(size_t, const Block &, const int *, size_t)> LocatedBlockFn;
+    size_t forEachLocatedBlock_(std::vector<std::pair<int, int>> &locations, const LocatedBlockFn &fn) const;
+    std::vector<GameRecord> fetchRecords_(std::vector<std::pair<int, int>> locations,
+                                          size_t *blocks_accessed) const;
+    friend class RecordCursor; // batches go through forEachLocatedBlock_()
+
+    // Shared tail of parseGameFields()/parseLines(): trims, checks and converts
+    // the nine field spans of one line
+    bool convertGameFields_(const char *const field_begin[9], const char *const field_end[9],
+                            GameRecord &record) const;
+
 public:
+    // On-disk layout: total_records | total_blocks | raw Block[total_blocks].
+    // Compressed files instead hold COMPRESSED_MAGIC | total_records |
+    // total_blocks | uint64 offsets[total_blocks + 1] | encoded blocks, each
+    // block at its offset from the end of the offset table.
+    static const size_t FILE_HEADER_SIZE = sizeof(size_t) * 2;
+    static const char COMPRESSED_MAGIC[8];
+
     DatabaseFile(const std::string &db_filename);
     ~DatabaseFile();
 
-    // Task 1: storage
-    bool loadFromTextFile(const std::string &text_filename);
+    // Layout for blocks created from now on (existing blocks keep theirs)
+    void setBlockLayout(BlockLayout layout) { block_layout = layout; }
+    BlockLayout getBlockLayout() const { return block_layout; }
+    // Format writeBlocksToDisk() writes in-memory blocks in (Raw by default).
+    // readBlocksFromDisk() and openCompressed() read compressed files;
+    // openMapped() and openWithBufferPool() need raw ones.
+    void setBlockEncoding(BlockEncoding encoding) { block_encoding = encoding; }
+    BlockEncoding getBlockEncoding() const { return block_encoding; }
+
+    // Task 1: storage. num_threads = 0 uses one parser thread per hardware thread.
+    bool loadFromTextFile(const std::string &text_filename, unsigned num_threads = 0);
     bool writeBlocksToDisk();
     bool readBlocksFromDisk();
     bool addRecord(const GameRecord &record);
 
+    // Durable alternative to addRecord(): the record is also logged to
+    // <filename>.wal, with one fsync per commit batch (group commit); a crash
+    // loses at most the records of the batch still pending. commit() forces
+    // that batch out. checkpoint() writes the blocks changed since the last
+    // one in place and empties the log. readBlocksFromDisk() and
+    // openWithBufferPool() replay the log; read-only opens do not.
+    bool appendRecord(const GameRecord &record);
+    bool commit();
+    bool checkpoint();
+    void setCommitBatch(size_t records);
+    size_t getCommitBatch() const { return commit_batch_; }
+    WalStats getWalStats() const { return wal_ ? wal_->getStats() : WalStats(); }
+
+    // Read-only alternative to readBlocksFromDisk(): maps the file instead of
+    // copying it, so opening costs the same regardless of file size.
+    bool openMapped();
+    bool isMapped() const { return mapped_file.isOpen(); }
+
+    // Read-only open of a compressed file: its blocks are read as stored and
+    // stay encoded; getBlock() decodes one block per call and scan()
+    // evaluates predicates on the encoded columns.
+    bool openCompressed();
+    bool isCompressed() const { return !encoded_offsets_.empty(); }
+
+    // Opens the file behind a buffer pool of frame_count blocks (default
+    // policy: CLOCK). Reads and addRecord() go through the pool; dirty blocks
+    // are written back on eviction, writeBlocksToDisk() or destruction.
+    bool openWithBufferPool(size_t frame_count, std::unique_ptr<EvictionPolicy> policy = nullptr);
+    bool hasBufferPool() const { return buffer_pool != nullptr; }
+    void displayBufferPoolStatistics() const;
+    void resetBufferPoolStatistics();
+    BufferPoolStats getBufferPoolStats() const { return buffer_pool ? buffer_pool->getStats() : BufferPoolStats(); }
+
     // Stats / access
     size_t getTotalRecords() const { return total_records; }
     size_t getTotalBlocks() const { return total_blocks; }
     size_t getRecordSize() const { return GameRecord::getRecordSize(); }
     int getRecordsPerBlock() const { return Block::getMaxRecordsPerBlock(); }
-    const Block &getBlock(size_t index) const { return blocks[index]; }
+    BlockRef getBlock(size_t index) const;
 
     void displayAllRecords() const;
     void displayStatistics() const;
 
     // Parsing and validation
     bool parseGameLine(const std::string &line, GameRecord &record);
+    bool parseGameFields(const char *begin, const char *end, GameRecord &record,
+                         bool &malformed) const;
+    // Parses every line in [begin, end) using the SIMD delimiter scan; valid
+    // records are appended to out, rejected lines counted in skipped and
+    // lines with too few fields reported in warnings.
+    void parseLines(const char *begin, const char *end, std::vector<GameRecord> &out,
+                    int &skipped, std::string &warnings,
+                    Simd::Level level = Simd::detectLevel()) const;
     bool isRecordValid(const GameRecord &record) const;
 
+    // Full-table scan: (block_id, record_id) of every live record matching all
+    // predicates, evaluated a block at a time by Block::evaluate() on the scan
+    // threads; results are in block/slot order regardless. Blocks
+    // whose zone map rules the predicates out are not read; blocks_accessed
+    // receives the number that were.
+    std::vector<std::pair<int, int>> scan(const std::vector<ScanPredicate> &predicates,
+                                          Simd::Level level = Simd::detectLevel(),
+                                          size_t *blocks_accessed = nullptr) const;
+
+    // Threads used by scan(), deleteByFTAboveLinear() and zone-map rebuilds
+    void setScanThreads(unsigned thread_count)
+    {
+        scan_threads_ = thread_count;
+        scan_pool_.reset();
+    }
+    unsigned getScanThreads() const { return scanWorkers_(); }
+    uint64_t getScanSteals() const { return scan_pool_ ? scan_pool_->getSteals() : 0; }
+
+    // Zone maps (on by default; off makes scans visit every block)
+    void setZoneMapsEnabled(bool enabled) { use_zone_maps_ = enabled; }
+    bool zoneMapsEnabled() const { return use_zone_maps_; }
+    bool blockMayMatch(size_t block_id, const std::vector<ScanPredicate> &predicates) const;
+    const BlockZone &getBlockZone(size_t block_id) const { return zone_maps_[block_id]; }
+
     // Task 2: indexes
-    bool buildIndexes();
-    std::vector<GameRecord> searchByTeamId(int team_id);
-    std::vector<GameRecord> searchByPointsRange(int min_pts, int max_pts);
-    std::vector<GameRecord> searchByFGPercentage(float min_pct, float max_pct);
-    std::vector<GameRecord> searchByFTPercentage(float min_pct, float max_pct);
+    bool buildIndexes(bool bulk_load = true, float fill_factor = 1.0f);
+    bool writeIndexesToDisk() const; // <filename>.<index>.idx
+    bool readIndexesFromDisk();
+    // Index searches return records in block/slot order: the matching RIDs
+    // are sorted and each data block is read once. blocks_accessed receives
+    // the number of distinct data blocks read.
+    std::vector<GameRecord> searchByTeamId(int team_id, size_t *blocks_accessed = nullptr);
+    std::vector<GameRecord> searchByPointsRange(int min_pts, int max_pts, size_t *blocks_accessed = nullptr);
+    std::vector<GameRecord> searchByFGPercentage(float min_pct, float max_pct, size_t *blocks_accessed = nullptr);
+    std::vector<GameRecord> searchByFTPercentage(float min_pct, float max_pct, size_t *blocks_accessed = nullptr);
+    // Dates in either "D/M/YYYY" or "YYYY-MM-DD" form, both ends inclusive
+    std::vector<GameRecord> searchByDateRange(const std::string &first, const std::string &last,
+                                              size_t *blocks_accessed = nullptr);
+    // Streaming versions of the searches above: rows are read as the cursor
+    // is pulled, at most limit of them
+    RecordCursor cursorByTeamId(int team_id, size_t limit = std::numeric_limits<size_t>::max()) const;
+    RecordCursor cursorByPointsRange(int min_pts, int max_pts,
+                                     size_t limit = std::numeric_limits<size_t>::max()) const;
+    RecordCursor cursorByFGPercentage(float min_pct, float max_pct,
+                                      size_t limit = std::numeric_limits<size_t>::max()) const;
+    RecordCursor cursorByFTPercentage(float min_pct, float max_pct,
+                                      size_t limit = std::numeric_limits<size_t>::max()) const;
+    RecordCursor cursorByDateRange(const std::string &first, const std::string &last,
+                                   size_t limit = std::numeric_limits<size_t>::max()) const;
+
+    // Average PTS and win count of rows with FT% > thresh. index_only answers
+    // from the covering FT index; otherwise each match is fetched from its block
+    CoveredStats aggregateFTAbove(float thresh, bool index_only = true);
+    // One team's games in a date range, via the composite (team, date) index
+    std::vector<GameRecord> searchByTeamAndDateRange(int team_id, const std::string &first,
+                                                     const std::string &last, size_t *blocks_accessed = nullptr);
     void displayIndexStatistics() const;
 
     // Task 3: tombstone helpers + deletion paths
     bool isDeleted(size_t block_id, int record_id) const;
     void markDeleted(size_t block_id, int record_id);
+    void clearDeleted(); // every record live again
 
     DeletionStats deleteByFTAboveIndexed(float thresh); // via FT% index
     DeletionStats deleteByFTAboveLinear(float thresh);  // full scan
@@ -235,6 +1465,39 @@ namespace Utils
     int safeStringToInt(const std::string &str);
     std::vector<std::string> split(const std::string &str, char delimiter);
     bool isEmptyOrWhitespace(const std::string &str); // NEW
+
+    // In-place, allocation-free variants over [first, last) for bulk ingest
+    void trimSpan(const char *&first, const char *&last);
+    bool isEmptyOrWhitespace(const char *first, const char *last);
+    int parseInt(const char *first, const char *last);
+    float parseFloat(const char *first, const char *last);
+    // "D/M/YYYY" or "YYYY-MM-DD" -> YYYYMMDD; 0 if it is not a calendar date.
+    // Any year parses, so query bounds can lie outside the stored range;
+    // records are only accepted for dates a DayCode reaches (isRecordValid)
+    int parseDateKey(const char *first, const char *last);
+    int parseDateKey(const std::string &date);
+    // YYYYMMDD -> "YYYY-MM-DD"
+    std::string formatDateKey(int key);
+}
+
+// =============================
+// Benchmarks (nba_db --bench <name> [data file])
+// =============================
+namespace Bench
+{
+    int run(const std::string &name, const std::string &data_file);
+    void tokenizer(const std::string &data_file, int scale);
+    void scan(const std::string &data_file, int scale);
+    void zoneMaps(const std::string &data_file, int scale);
+    void threads(const std::string &data_file, int scale);
+    bool indexes(const std::string &data_file, int scale, int queries);
+    void nodeSearch(const std::string &data_file);
+    void fanout(const std::string &data_file, int scale);
+    void fetch(const std::string &data_file, int scale);
+    bool cursors(const std::string &data_file, int scale);
+    void treeMemory(const std::string &data_file, int scale);
+    bool compression(const std::string &data_file, int scale);
+    bool writeAheadLog(const std::string &data_file, int scale);
 }
 
 #endif // GAME_RECORD_H
\ No newline at end of file
@@ -4,98 +4,329 @@
 #include <cstring>
 #include <type_traits>
 #include <iomanip>
+#include <cmath>
+#include <unordered_map>
+
+static_assert(sizeof(PostingPage) <= IndexManager::INDEX_PAGE_SIZE, "overflow page exceeds an index page");
 
 // =============================
-// B+ Tree Node (existing base)
+// Posting lists
 // =============================
-template<typename KeyType>
-BPlusTreeNode<KeyType>::BPlusTreeNode(bool leaf) : is_leaf(leaf), key_count(0)
+PageArena::PageArena(PageArena&& other)
+    : slabs_(std::move(other.slabs_)), used_(other.used_), free_(other.free_), live_(other.live_)
 {
-    for (int i = 0; i < MAX_KEYS; i++) keys[i] = KeyType{};
-    if (is_leaf) {
-        leaf_data.next_leaf = nullptr;
-        for (int i = 0; i < MAX_KEYS; i++) {
-            leaf_data.block_ids[i] = -1;
-            leaf_data.record_ids[i] = -1;
-        }
-    } else {
-        for (int i = 0; i <= MAX_KEYS; i++) children[i] = nullptr;
+    other.used_ = SLAB_PAGES;
+    other.free_ = nullptr;
+    other.live_ = 0;
+}
+
+PageArena& PageArena::operator=(PageArena&& other)
+{
+    if (this != &other) {
+        slabs_ = std::move(other.slabs_);
+        used_ = other.used_;
+        free_ = other.free_;
+        live_ = other.live_;
+        other.slabs_.clear();
+        other.used_ = SLAB_PAGES;
+        other.free_ = nullptr;
+        other.live_ = 0;
+    }
+    return *this;
+}
+
+PostingPage* PageArena::allocate()
+{
+    live_++;
+    if (free_) {
+        PostingPage* page = free_;
+        free_ = page->next;
+        return page;
+    }
+    if (used_ == SLAB_PAGES) {
+        slabs_.emplace_back(new PostingPage[SLAB_PAGES]);
+        used_ = 0;
+    }
+    return &slabs_.back()[used_++];
+}
+
+void PageArena::release(PostingPage* page)
+{
+    page->next = free_;
+    free_ = page;
+    live_--;
+}
+
+void PageArena::clear()
+{
+    slabs_.clear();
+    used_ = SLAB_PAGES;
+    free_ = nullptr;
+    live_ = 0;
+}
+
+size_t PostingList::pageCount() const
+{
+    size_t pages = 0;
+    if (isOverflow()) {
+        for (const PostingPage* p = overflow; p; p = p->next) pages++;
+    }
+    return pages;
+}
+
+// Short lists stay inline; longer ones are packed into full overflow pages
+void PostingList::assign(const RID* rids, int n, PageArena& pages)
+{
+    clear(pages);
+    count = n;
+    if (n <= INLINE_RIDS) {
+        std::copy(rids, rids + n, inline_rids);
+        return;
+    }
+    PostingPage** link = &overflow;
+    for (int done = 0; done < n;) {
+        PostingPage* page = pages.allocate();
+        page->count = n - done < PostingPage::CAPACITY ? n - done : PostingPage::CAPACITY;
+        page->next = nullptr;
+        std::copy(rids + done, rids + done + page->count, page->rids);
+        done += page->count;
+        *link = page;
+        link = &page->next;
+    }
+}
+
+void PostingList::insert(RID rid, PageArena& pages)
+{
+    if (count < INLINE_RIDS) {
+        RID* pos = std::upper_bound(inline_rids, inline_rids + count, rid);
+        std::copy_backward(pos, inline_rids + count, inline_rids + count + 1);
+        *pos = rid;
+        count++;
+        return;
+    }
+    if (count == INLINE_RIDS) {
+        // Spill: inline RIDs plus the new one become the first overflow page
+        RID all[INLINE_RIDS + 1];
+        RID* pos = std::upper_bound(inline_rids, inline_rids + count, rid);
+        RID* out = std::copy(inline_rids, pos, all);
+        *out++ = rid;
+        std::copy(pos, inline_rids + count, out);
+        count = 0;
+        assign(all, INLINE_RIDS + 1, pages);
+        return;
+    }
+
+    // Last page whose first RID is <= rid; a full page splits in half first
+    PostingPage* page = overflow;
+    while (page->next && !(rid < page->next->rids[0])) page = page->next;
+    if (page->count == PostingPage::CAPACITY) {
+        PostingPage* right = pages.allocate();
+        const int half = PostingPage::CAPACITY / 2;
+        right->count = PostingPage::CAPACITY - half;
+        std::copy(page->rids + half, page->rids + PostingPage::CAPACITY, right->rids);
+        right->next = page->next;
+        page->next = right;
+        page->count = half;
+        if (!(rid < right->rids[0])) page = right;
+    }
+    RID* pos = std::upper_bound(page->rids, page->rids + page->count, rid);
+    std::copy_backward(pos, page->rids + page->count, page->rids + page->count + 1);
+    *pos = rid;
+    page->count++;
+    count++;
+}
+
+bool PostingList::erase(RID rid, PageArena& pages)
+{
+    if (!isOverflow()) {
+        RID* pos = std::lower_bound(inline_rids, inline_rids + count, rid);
+        if (pos == inline_rids + count || !(*pos == rid)) return false;
+        std::copy(pos + 1, inline_rids + count, pos);
+        count--;
+        return true;
+    }
+
+    // Page whose run holds rid; an emptied page is unlinked
+    PostingPage** link = &overflow;
+    while ((*link)->next && !(rid < (*link)->next->rids[0])) link = &(*link)->next;
+    PostingPage* page = *link;
+    RID* pos = std::lower_bound(page->rids, page->rids + page->count, rid);
+    if (pos == page->rids + page->count || !(*pos == rid)) return false;
+    std::copy(pos + 1, page->rids + page->count, pos);
+    if (--page->count == 0) {
+        *link = page->next;
+        pages.release(page);
     }
+    if (count - 1 > INLINE_RIDS) {
+        count--;
+        return true;
+    }
+
+    // Back under the inline limit: pull the survivors into the slot (count
+    // still marks the chain, for forEach() and clear())
+    RID all[INLINE_RIDS];
+    int n = 0;
+    forEach([&](const RID& r) { all[n++] = r; });
+    clear(pages);
+    count = n;
+    std::copy(all, all + n, inline_rids);
+    return true;
 }
 
-template<typename KeyType>
-BPlusTreeNode<KeyType>::~BPlusTreeNode()
+void PostingList::clear(PageArena& pages)
 {
-    if (!is_leaf) {
-        for (int i = 0; i <= key_count; i++) {
-            delete children[i];
+    if (isOverflow()) {
+        for (PostingPage* p = overflow; p;) {
+            PostingPage* next = p->next;
+            pages.release(p);
+            p = next;
         }
     }
+    count = 0;
+}
+
+void PostingList::appendTo(std::vector<std::pair<int, int>>& out) const
+{
+    forEach([&](const RID& r) { out.emplace_back(r.blockId(), r.recordId()); });
+}
+
+// =============================
+// B+ Tree Node (existing base)
+// =============================
+template<typename KeyType, int Fanout>
+BPlusTreeNode<KeyType, Fanout>::BPlusTreeNode() : key_count(0)
+{
+    for (int i = 0; i < MAX_KEYS; i++) keys[i] = KeyType{};
+}
+
+template<typename KeyType, int Fanout>
+BPlusTreeLeaf<KeyType, Fanout>::BPlusTreeLeaf() : next_leaf(NULL_NODE)
+{
+    for (int i = 0; i < Fanout; i++) postings[i].count = 0;
+}
+
+template<typename KeyType, int Fanout>
+BPlusTreeInternal<KeyType, Fanout>::BPlusTreeInternal()
+{
+    for (int i = 0; i <= Fanout; i++) children[i] = NULL_NODE;
 }
 
 // =============================
 // IndexManager (Task 2 base)
 // =============================
-IndexManager::IndexManager()
-    : team_id_index(nullptr), points_index(nullptr),
-      fg_pct_index(nullptr), date_index(nullptr), ft_pct_index(nullptr) {}
+namespace {
+    FTCoveringKey coveringKey(const GameRecord& record) {
+        return FTCoveringKey{record.ft_pct_home, {record.pts_home, record.home_team_wins}};
+    }
+}
 
-IndexManager::~IndexManager()
+bool IndexManager::buildIndexes(const DatabaseFile& db, bool bulk_load, float fill_factor)
 {
-    delete team_id_index;
-    delete points_index;
-    delete fg_pct_index;
-    delete date_index;
-    delete ft_pct_index;
+    std::cout << (bulk_load ? "Bulk-loading" : "Building") << " B+ tree indexes with page-sized nodes (max "
+              << BPlusTreeNode<int>::MAX_KEYS << " keys per node";
+    if (bulk_load) std::cout << ", fill factor " << std::fixed << std::setprecision(2) << fill_factor;
+    std::cout << ")..." << std::endl;
+
+    buildAllIndexes(db, true, bulk_load, fill_factor); // tombstoned rows stay out
+
+    if (bulk_load) std::cout << "B+ tree indexes bulk-loaded successfully!" << std::endl;
+    else           std::cout << "B+ tree indexes built successfully with node splitting!" << std::endl;
+    return true;
 }
 
-bool IndexManager::buildIndexes(const DatabaseFile& db)
+bool IndexManager::buildAllIndexes(const DatabaseFile& db, bool skip_deleted,
+                                   bool bulk_load, float fill_factor)
 {
-    std::cout << "Building B+ tree indexes with max 20 keys per node..." << std::endl;
+    // Each tree starts over from an empty root leaf
+    team_id_index.clear(); points_index.clear(); fg_pct_index.clear();
+    date_index.clear();    ft_pct_index.clear(); team_date_index.clear();
+    ft_cover_index.clear();
+    team_id_index.root   = team_id_index.newLeaf();
+    points_index.root    = points_index.newLeaf();
+    fg_pct_index.root    = fg_pct_index.newLeaf();
+    date_index.root      = date_index.newLeaf();
+    ft_pct_index.root    = ft_pct_index.newLeaf();
+    team_date_index.root = team_date_index.newLeaf();
+    ft_cover_index.root  = ft_cover_index.newLeaf();
+
+    if (!bulk_load) {
+        // Insert all records one at a time
+        for (size_t block_idx = 0; block_idx < db.getTotalBlocks(); block_idx++) {
+            BlockRef block = db.getBlock(block_idx);
+            for (int record_idx = 0; record_idx < block->record_count; record_idx++) {
+                if (skip_deleted && db.isDeleted(block_idx, record_idx)) continue;
+                GameRecord record = block->getRecord(record_idx);
+                insert(team_id_index, record.team_id_home,           (int)block_idx, record_idx);
+                insert(points_index,  record.pts_home,               (int)block_idx, record_idx);
+                insert(fg_pct_index,  record.fg_pct_home,            (int)block_idx, record_idx);
+                insert(date_index,    DayCode::fromDateKey(record.game_date), (int)block_idx, record_idx);
+                insert(ft_pct_index,  record.ft_pct_home,            (int)block_idx, record_idx);
+                insert(team_date_index, TeamDateKey{record.team_id_home, record.game_date},
+                       (int)block_idx, record_idx);
+                insert(ft_cover_index, coveringKey(record), (int)block_idx, record_idx);
+            }
+        }
+        return true;
+    }
 
-    // Fresh roots
-    team_id_index = new BPlusTreeNode<int>(true);
-    points_index  = new BPlusTreeNode<int>(true);
-    fg_pct_index  = new BPlusTreeNode<float>(true);
-    date_index    = new BPlusTreeNode<std::string>(true);
-    ft_pct_index  = new BPlusTreeNode<float>(true);
+    // Gather (key, block_id, record_id) tuples once per index, then pack bottom-up
+    std::vector<IndexEntry<int>>   team_entries, pts_entries;
+    std::vector<IndexEntry<float>> fg_entries, ft_entries;
+    std::vector<IndexEntry<DayCode>> date_entries;
+    std::vector<IndexEntry<TeamDateKey>> team_date_entries;
+    std::vector<IndexEntry<FTCoveringKey>> ft_cover_entries;
+    team_entries.reserve(db.getTotalRecords());
+    pts_entries.reserve(db.getTotalRecords());
+    fg_entries.reserve(db.getTotalRecords());
+    ft_entries.reserve(db.getTotalRecords());
+    date_entries.reserve(db.getTotalRecords());
+    team_date_entries.reserve(db.getTotalRecords());
+    ft_cover_entries.reserve(db.getTotalRecords());
 
-    // Insert all records
     for (size_t block_idx = 0; block_idx < db.getTotalBlocks(); block_idx++) {
-        const Block& block = db.getBlock(block_idx);
-        for (int record_idx = 0; record_idx < block.record_count; record_idx++) {
-            GameRecord record = block.getRecord(record_idx);
-            insert(team_id_index, record.team_id_home,           (int)block_idx, record_idx);
-            insert(points_index,  record.pts_home,               (int)block_idx, record_idx);
-            insert(fg_pct_index,  record.fg_pct_home,            (int)block_idx, record_idx);
-            insert(date_index,    std::string(record.game_date), (int)block_idx, record_idx);
-            insert(ft_pct_index,  record.ft_pct_home,            (int)block_idx, record_idx);
+        BlockRef block = db.getBlock(block_idx);
+        for (int record_idx = 0; record_idx < block->record_count; record_idx++) {
+            if (skip_deleted && db.isDeleted(block_idx, record_idx)) continue;
+            GameRecord record = block->getRecord(record_idx);
+            const int b = (int)block_idx;
+            team_entries.push_back({record.team_id_home,           b, record_idx});
+            pts_entries.push_back ({record.pts_home,               b, record_idx});
+            fg_entries.push_back  ({record.fg_pct_home,            b, record_idx});
+            date_entries.push_back({DayCode::fromDateKey(record.game_date), b, record_idx});
+            ft_entries.push_back  ({record.ft_pct_home,            b, record_idx});
+            team_date_entries.push_back({{record.team_id_home, record.game_date}, b, record_idx});
+            ft_cover_entries.push_back({coveringKey(record), b, record_idx});
         }
     }
 
-    std::cout << "B+ tree indexes built successfully with node splitting!" << std::endl;
+    bulkLoad(team_id_index, team_entries, fill_factor);
+    bulkLoad(points_index,  pts_entries,  fill_factor);
+    bulkLoad(fg_pct_index,  fg_entries,   fill_factor);
+    bulkLoad(date_index,    date_entries, fill_factor);
+    bulkLoad(ft_pct_index,  ft_entries,   fill_factor);
+    bulkLoad(team_date_index, team_date_entries, fill_factor);
+    bulkLoad(ft_cover_index,  ft_cover_entries,  fill_factor);
     return true;
 }
 
 // =============================
 // Core B+ ops (existing)
 // =============================
-template<typename KeyType>
-bool IndexManager::insert(BPlusTreeNode<KeyType>*& root, KeyType key, int block_id, int record_id)
+template<typename KeyType, int Fanout>
+bool IndexManager::insert(BPlusTree<KeyType, Fanout>& tree, KeyType key, int block_id, int record_id)
 {
-    using Node = BPlusTreeNode<KeyType>;
-    const int MAX_KEYS = Node::MAX_KEYS;
+    using Internal = BPlusTreeInternal<KeyType, Fanout>;
+    const int MAX_KEYS = BPlusTreeNode<KeyType, Fanout>::MAX_KEYS;
 
-    if (!root) root = new Node(true);
+    if (tree.root == NULL_NODE) tree.root = tree.newLeaf();
 
-    // If root is a leaf and has space
-    if (root->is_leaf && root->key_count < MAX_KEYS) {
-        return insertIntoLeaf(root, key, block_id, record_id);
-    }
+    // Root leaf with room (or already holding key)
+    if (tree.isLeaf(tree.root) && insertIntoLeaf(tree, tree.root, key, block_id, record_id)) return true;
 
     // Split internal helper
-    auto splitInternalHere = [&](Node* left, KeyType& promoted_key_out) -> Node* {
-        Node* right = new Node(false);
+    auto splitInternalHere = [&](Internal* left, KeyType& promoted_key_out) -> NodeHandle {
+        const NodeHandle right_handle = tree.newInternal();
+        Internal* right = &tree.internal(right_handle);
         int mid = left->key_count / 2;
         promoted_key_out = left->keys[mid];
 
@@ -109,42 +340,40 @@ bool IndexManager::insert(BPlusTreeNode<KeyType>*& root, KeyType key, int block_
         }
 
         left->key_count = mid;
-        return right;
+        return right_handle;
     };
 
     // Descend while remembering path
-    Node* path_nodes[128];
-    int   path_pos[128];
+    Internal* path_nodes[128];
+    int       path_pos[128];
     int depth = 0;
 
-    Node* cur = root;
-    while (!cur->is_leaf) {
-        int pos = 0;
-        while (pos < cur->key_count && key > cur->keys[pos]) pos++;
-        path_nodes[depth] = cur;
+    NodeHandle cur = tree.root;
+    while (!tree.isLeaf(cur)) {
+        Internal* n = &tree.internal(cur);
+        int pos = n->childIndex(key);
+        path_nodes[depth] = n;
         path_pos[depth] = pos;
         depth++;
 
-        if (!cur->children[pos]) cur->children[pos] = new Node(true);
-        cur = cur->children[pos];
+        if (n->children[pos] == NULL_NODE) n->children[pos] = tree.newLeaf();
+        cur = n->children[pos];
     }
 
-    // Leaf insert or split
-    if (cur->key_count < MAX_KEYS) {
-        return insertIntoLeaf(cur, key, block_id, record_id);
-    }
+    // Leaf insert (new key with room, or another RID for an existing key) or split
+    if (insertIntoLeaf(tree, cur, key, block_id, record_id)) return true;
 
-    auto split_res = splitLeaf(cur);
+    auto split_res = splitLeaf(tree, cur);
     KeyType promoted_key = split_res.first;
-    Node* new_right = split_res.second;
-    if (!new_right) return false;
+    NodeHandle new_right = split_res.second;
+    if (new_right == NULL_NODE) return false;
 
-    if (key < promoted_key) insertIntoLeaf(cur, key, block_id, record_id);
-    else                    insertIntoLeaf(new_right, key, block_id, record_id);
+    if (key < promoted_key) insertIntoLeaf(tree, cur, key, block_id, record_id);
+    else                    insertIntoLeaf(tree, new_right, key, block_id, record_id);
 
     // Bubble up
     for (int i = depth - 1; i >= 0; --i) {
-        Node* parent = path_nodes[i];
+        Internal* parent = path_nodes[i];
         int insert_pos = path_pos[i];
 
         for (int k = parent->key_count; k > insert_pos; --k) {
@@ -158,121 +387,528 @@ bool IndexManager::insert(BPlusTreeNode<KeyType>*& root, KeyType key, int block_
         if (parent->key_count < MAX_KEYS) return true;
 
         KeyType parent_promoted;
-        Node* parent_right = splitInternalHere(parent, parent_promoted);
+        NodeHandle parent_right = splitInternalHere(parent, parent_promoted);
 
         promoted_key = parent_promoted;
         new_right = parent_right;
     }
 
-    Node* new_root = new Node(false);
-    new_root->keys[0] = promoted_key;
-    new_root->children[0] = root;
-    new_root->children[1] = new_right;
-    new_root->key_count = 1;
-    root = new_root;
+    const NodeHandle new_root = tree.newInternal();
+    Internal& r = tree.internal(new_root);
+    r.keys[0] = promoted_key;
+    r.children[0] = tree.root;
+    r.children[1] = new_right;
+    r.key_count = 1;
+    tree.root = new_root;
     return true;
 }
 
-template<typename KeyType>
-bool IndexManager::insertIntoLeaf(BPlusTreeNode<KeyType>* leaf, KeyType key, int block_id, int record_id)
+// Adds the RID to key's posting list, taking a new slot if key is not in the
+// leaf yet; false only when that needs a slot and the leaf is full
+template<typename KeyType, int Fanout>
+bool IndexManager::insertIntoLeaf(BPlusTree<KeyType, Fanout>& tree, NodeHandle leaf_handle, KeyType key,
+                                  int block_id, int record_id)
 {
-    static const int MAX_KEYS = BPlusTreeNode<KeyType>::MAX_KEYS;
-    if (!leaf || leaf->key_count >= MAX_KEYS) return false;
-
-    int pos = 0;
-    while (pos < leaf->key_count && leaf->keys[pos] < key) pos++;
+    static const int MAX_KEYS = BPlusTreeNode<KeyType, Fanout>::MAX_KEYS;
+    if (leaf_handle == NULL_NODE) return false;
+    BPlusTreeLeaf<KeyType, Fanout>* leaf = &tree.leaf(leaf_handle);
+
+    int pos = leaf->keyIndex(key);
+    if (pos < leaf->key_count && !(key < leaf->keys[pos])) {
+        leaf->postings[pos].insert(RID::at(block_id, record_id), tree.pages);
+        return true;
+    }
+    if (leaf->key_count >= MAX_KEYS) return false;
 
     for (int i = leaf->key_count; i > pos; i--) {
         leaf->keys[i] = leaf->keys[i-1];
-        leaf->leaf_data.block_ids[i]  = leaf->leaf_data.block_ids[i-1];
-        leaf->leaf_data.record_ids[i] = leaf->leaf_data.record_ids[i-1];
+        leaf->postings[i] = leaf->postings[i-1];
     }
 
     leaf->keys[pos] = key;
-    leaf->leaf_data.block_ids[pos]  = block_id;
-    leaf->leaf_data.record_ids[pos] = record_id;
+    leaf->postings[pos].count = 0;
+    leaf->postings[pos].insert(RID::at(block_id, record_id), tree.pages);
     leaf->key_count++;
     return true;
 }
 
-template<typename KeyType>
-std::pair<KeyType, BPlusTreeNode<KeyType>*> IndexManager::splitLeaf(BPlusTreeNode<KeyType>* leaf)
+template<typename KeyType, int Fanout>
+std::pair<KeyType, NodeHandle> IndexManager::splitLeaf(BPlusTree<KeyType, Fanout>& tree, NodeHandle leaf_handle)
 {
-    static const int MAX_KEYS = BPlusTreeNode<KeyType>::MAX_KEYS;
-    if (!leaf) return std::make_pair(KeyType{}, nullptr);
+    static const int MAX_KEYS = BPlusTreeNode<KeyType, Fanout>::MAX_KEYS;
+    if (leaf_handle == NULL_NODE) return std::make_pair(KeyType{}, NULL_NODE);
 
-    auto* new_leaf = new BPlusTreeNode<KeyType>(true);
+    const NodeHandle new_handle = tree.newLeaf();
+    auto* leaf = &tree.leaf(leaf_handle);
+    auto* new_leaf = &tree.leaf(new_handle);
     int split_point = leaf->key_count / 2;
 
     int j = 0;
     for (int i = split_point; i < leaf->key_count && i < MAX_KEYS && j < MAX_KEYS; i++, j++) {
         new_leaf->keys[j] = leaf->keys[i];
-        new_leaf->leaf_data.block_ids[j]  = leaf->leaf_data.block_ids[i];
-        new_leaf->leaf_data.record_ids[j] = leaf->leaf_data.record_ids[i];
+        new_leaf->postings[j] = leaf->postings[i]; // ownership moves
 
         leaf->keys[i] = KeyType{};
-        leaf->leaf_data.block_ids[i]  = -1;
-        leaf->leaf_data.record_ids[i] = -1;
+        leaf->postings[i].count = 0;
     }
     new_leaf->key_count = j;
 
     leaf->key_count = split_point;
 
-    new_leaf->leaf_data.next_leaf = leaf->leaf_data.next_leaf;
-    leaf->leaf_data.next_leaf = new_leaf;
+    new_leaf->next_leaf = leaf->next_leaf;
+    leaf->next_leaf = new_handle;
 
     KeyType promoted_key = (new_leaf->key_count > 0) ? new_leaf->keys[0] : KeyType{};
-    return std::make_pair(promoted_key, new_leaf);
+    return std::make_pair(promoted_key, new_handle);
 }
 
-template<typename KeyType>
-std::vector<std::pair<int, int>> IndexManager::search(BPlusTreeNode<KeyType>* root, KeyType key)
+// =============================
+// Deletion (borrow / merge / shrink)
+// =============================
+// Drops one RID from key's posting list. A key whose list empties leaves its
+// leaf; a node that falls below MIN_KEYS then borrows one entry from an
+// adjacent sibling, or merges with it when both fit one node, which removes a
+// separator from the parent and may cascade upwards. An internal root left
+// without keys is replaced by its only child.
+template<typename KeyType, int Fanout>
+bool IndexManager::remove(BPlusTree<KeyType, Fanout>& tree, const KeyType& key, int block_id, int record_id)
 {
-    std::vector<std::pair<int, int>> results;
-    if (!root) return results;
+    using Node = BPlusTreeNode<KeyType, Fanout>;
+    using Leaf = BPlusTreeLeaf<KeyType, Fanout>;
+    using Internal = BPlusTreeInternal<KeyType, Fanout>;
+    const int MAX_KEYS = Node::MAX_KEYS;
+    const int MIN_KEYS = Node::MIN_KEYS;
+    if (tree.root == NULL_NODE) return false;
+
+    // Descend while remembering path
+    Internal* path_nodes[128];
+    int       path_pos[128];
+    int depth = 0;
+
+    NodeHandle cur = tree.root;
+    while (!tree.isLeaf(cur)) {
+        Internal* n = &tree.internal(cur);
+        int pos = n->childIndex(key);
+        path_nodes[depth] = n;
+        path_pos[depth] = pos;
+        depth++;
+        if (n->children[pos] == NULL_NODE) return false;
+        cur = n->children[pos];
+    }
+
+    Leaf* leaf = &tree.leaf(cur);
+    int slot = leaf->keyIndex(key);
+    if (slot >= leaf->key_count || key < leaf->keys[slot]) return false;
+    PostingList& pl = leaf->postings[slot];
+    if (!pl.erase(RID::at(block_id, record_id), tree.pages)) return false;
+    if (pl.count > 0) return true;
+
+    for (int i = slot; i + 1 < leaf->key_count; i++) {
+        leaf->keys[i] = leaf->keys[i + 1];
+        leaf->postings[i] = leaf->postings[i + 1];
+    }
+    leaf->key_count--;
+    leaf->postings[leaf->key_count].count = 0;
+
+    // Rebalance bottom-up; the node at each level is parent->children[c]
+    for (int d = depth - 1; d >= 0 && tree.node(cur).key_count < MIN_KEYS; --d) {
+        Internal* parent = path_nodes[d];
+        const int c = path_pos[d];
+        // Pair the node with its left sibling when it has one; sep separates the pair
+        const int sep = c > 0 ? c - 1 : c;
+        const NodeHandle left_handle = parent->children[sep];
+        const NodeHandle right_handle = parent->children[sep + 1];
+
+        bool merge;
+        if (tree.isLeaf(cur)) {
+            Leaf* left  = &tree.leaf(left_handle);
+            Leaf* right = &tree.leaf(right_handle);
+            merge = left->key_count + right->key_count <= MAX_KEYS;
+            if (merge) {
+                for (int i = 0; i < right->key_count; i++) {
+                    left->keys[left->key_count + i] = right->keys[i];
+                    left->postings[left->key_count + i] = right->postings[i];
+                }
+                left->key_count += right->key_count;
+                left->next_leaf = right->next_leaf;
+            } else if (left_handle == cur) {
+                // Borrow the right sibling's first key
+                left->keys[left->key_count] = right->keys[0];
+                left->postings[left->key_count] = right->postings[0];
+                left->key_count++;
+                for (int i = 0; i + 1 < right->key_count; i++) {
+                    right->keys[i] = right->keys[i + 1];
+                    right->postings[i] = right->postings[i + 1];
+                }
+                right->key_count--;
+                right->postings[right->key_count].count = 0;
+                parent->keys[sep] = right->keys[0];
+            } else {
+                // Borrow the left sibling's last key
+                for (int i = right->key_count; i > 0; i--) {
+                    right->keys[i] = right->keys[i - 1];
+                    right->postings[i] = right->postings[i - 1];
+                }
+                left->key_count--;
+                right->keys[0] = left->keys[left->key_count];
+                right->postings[0] = left->postings[left->key_count];
+                left->postings[left->key_count].count = 0;
+                right->key_count++;
+                parent->keys[sep] = right->keys[0];
+            }
+            if (merge) right->key_count = 0;
+        } else {
+            Internal* left  = &tree.internal(left_handle);
+            Internal* right = &tree.internal(right_handle);
+            // Internal nodes stay below MAX_KEYS keys, as after insert()
+            merge = left->key_count + right->key_count + 1 <= MAX_KEYS - 1;
+            if (merge) {
+                // The separator comes down between the two key runs
+                left->keys[left->key_count] = parent->keys[sep];
+                for (int i = 0; i < right->key_count; i++) {
+                    left->keys[left->key_count + 1 + i] = right->keys[i];
+                }
+                for (int i = 0; i <= right->key_count; i++) {
+                    left->children[left->key_count + 1 + i] = right->children[i];
+                    right->children[i] = NULL_NODE;
+                }
+                left->key_count += right->key_count + 1;
+                right->key_count = 0;
+            } else if (left_handle == cur) {
+                // Rotate left: separator down, right's first key up
+                left->keys[left->key_count] = parent->keys[sep];
+                left->children[left->key_count + 1] = right->children[0];
+                left->key_count++;
+                parent->keys[sep] = right->keys[0];
+                for (int i = 0; i + 1 < right->key_count; i++) right->keys[i] = right->keys[i + 1];
+                for (int i = 0; i < right->key_count; i++) right->children[i] = right->children[i + 1];
+                right->children[right->key_count] = NULL_NODE;
+                right->key_count--;
+            } else {
+                // Rotate right: separator down, left's last key up
+                for (int i = right->key_count; i > 0; i--) right->keys[i] = right->keys[i - 1];
+                for (int i = right->key_count + 1; i > 0; i--) right->children[i] = right->children[i - 1];
+                right->keys[0] = parent->keys[sep];
+                right->children[0] = left->children[left->key_count];
+                left->children[left->key_count] = NULL_NODE;
+                parent->keys[sep] = left->keys[left->key_count - 1];
+                left->key_count--;
+                right->key_count++;
+            }
+        }
+        if (!merge) return true;
+
+        // right is now empty: drop it and its separator from the parent
+        tree.release(right_handle);
+        for (int i = sep; i + 1 < parent->key_count; i++) {
+            parent->keys[i] = parent->keys[i + 1];
+            parent->children[i + 1] = parent->children[i + 2];
+        }
+        parent->children[parent->key_count] = NULL_NODE;
+        parent->key_count--;
+        cur = d > 0 ? path_nodes[d - 1]->children[path_pos[d - 1]] : tree.root;
+    }
+
+    if (!tree.isLeaf(tree.root) && tree.internal(tree.root).key_count == 0) {
+        const NodeHandle old_root = tree.root;
+        tree.root = tree.internal(old_root).children[0];
+        tree.release(old_root);
+    }
+    return true;
+}
 
-    if (root->is_leaf) {
-        for (int i = 0; i < root->key_count; i++) {
-            if (root->keys[i] == key) {
-                results.emplace_back(root->leaf_data.block_ids[i], root->leaf_data.record_ids[i]);
+// Walks the whole tree once; key bounds come down from the separators
+template<typename KeyType, int Fanout>
+bool IndexManager::checkTree(const std::string& index_name, const BPlusTree<KeyType, Fanout>& tree) const
+{
+    using Node = BPlusTreeNode<KeyType, Fanout>;
+    if (tree.root == NULL_NODE) return true;
+
+    struct Frame { NodeHandle node; int depth; const KeyType* lo; const KeyType* hi; };
+    std::vector<Frame> stack{{tree.root, 0, nullptr, nullptr}};
+    std::vector<NodeHandle> leaves; // in key order
+    int leaf_depth = -1;
+    size_t nodes = 0, pages = 0;
+    std::string problem;
+
+    while (!stack.empty() && problem.empty()) {
+        Frame f = stack.back();
+        stack.pop_back();
+        const Node* n = &tree.node(f.node);
+        nodes++;
+        if (f.node != tree.root && n->key_count < 1) problem = "empty non-root node";
+        for (int i = 0; i < n->key_count && problem.empty(); i++) {
+            if (i > 0 && !(n->keys[i - 1] < n->keys[i])) problem = "keys out of order";
+            if (f.lo && n->keys[i] < *f.lo) problem = "key below its separator";
+            if (f.hi && !(n->keys[i] < *f.hi)) problem = "key not below the next separator";
+        }
+        if (!problem.empty()) break;
+
+        if (tree.isLeaf(f.node)) {
+            if (leaf_depth < 0) leaf_depth = f.depth;
+            if (f.depth != leaf_depth) problem = "leaves at different depths";
+            for (int i = 0; i < n->key_count && problem.empty(); i++) {
+                const PostingList& pl = tree.leaf(f.node).postings[i];
+                int seen = 0;
+                bool ordered = true;
+                const RID* prev = nullptr;
+                pl.forEach([&](const RID& r) {
+                    if (prev && !(*prev < r)) ordered = false;
+                    prev = &r;
+                    seen++;
+                });
+                if (pl.count == 0) problem = "empty posting list";
+                else if (seen != pl.count || !ordered) problem = "posting list count or order";
+                pages += pl.pageCount();
             }
+            leaves.push_back(f.node);
+            continue;
+        }
+        // Push children right to left so leaves pop in key order
+        const NodeHandle* children = tree.internal(f.node).children;
+        for (int i = n->key_count; i >= 0; i--) {
+            if (children[i] == NULL_NODE) { problem = "missing child"; break; }
+            stack.push_back({children[i], f.depth + 1,
+                             i > 0 ? &n->keys[i - 1] : f.lo,
+                             i < n->key_count ? &n->keys[i] : f.hi});
         }
-    } else {
-        int pos = 0;
-        while (pos < root->key_count && key > root->keys[pos]) pos++;
-        return search(root->children[pos], key);
     }
+
+    for (size_t i = 0; i < leaves.size() && problem.empty(); i++) {
+        const NodeHandle expected = i + 1 < leaves.size() ? leaves[i + 1] : NULL_NODE;
+        if (tree.leaf(leaves[i]).next_leaf != expected) problem = "broken leaf chain";
+    }
+    // Every live node and overflow page in the arenas is reachable from the root
+    if (problem.empty() && (nodes != tree.liveNodes() || pages != tree.pages.livePages())) {
+        problem = "arena holds unreachable nodes or pages";
+    }
+    if (problem.empty()) return true;
+    std::cerr << "Error: " << index_name << " index: " << problem << std::endl;
+    return false;
+}
+
+// Bottom-up bulk load: sort once, pack one leaf slot per distinct key (its
+// RIDs become the posting list) left to right, then build each internal
+// level over the one below until a single root remains.
+template<typename KeyType, int Fanout>
+void IndexManager::bulkLoad(BPlusTree<KeyType, Fanout>& tree,
+                            std::vector<IndexEntry<KeyType>>& entries, float fill_factor)
+{
+    using Leaf = BPlusTreeLeaf<KeyType, Fanout>;
+    using Internal = BPlusTreeInternal<KeyType, Fanout>;
+    const int MAX_KEYS = BPlusTreeNode<KeyType, Fanout>::MAX_KEYS;
+
+    tree.clear();
+    tree.root = tree.newLeaf();
+    if (entries.empty()) return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const IndexEntry<KeyType>& a, const IndexEntry<KeyType>& b) {
+                  if (a.key < b.key) return true;
+                  if (b.key < a.key) return false;
+                  if (a.block_id != b.block_id) return a.block_id < b.block_id;
+                  return a.record_id < b.record_id;
+              });
+
+    // Below half full the tree would violate MIN_KEYS; above 1.0 is meaningless.
+    fill_factor = std::min(1.0f, std::max(0.5f, fill_factor));
+    // Leaves hold up to MAX_KEYS entries; internal nodes are kept at most
+    // MAX_KEYS children (MAX_KEYS - 1 keys) so insert() can still add a key
+    // before it splits.
+    const int leaf_cap  = std::max(1, (int)std::ceil(fill_factor * MAX_KEYS));
+    const int child_cap = std::max(3, (int)std::ceil(fill_factor * MAX_KEYS));
+
+    // Number of nodes needed for `count` items at `cap` per node; items are then
+    // spread evenly so the last node is not left underfull.
+    auto groupsFor = [](size_t count, int cap) { return (count + cap - 1) / cap; };
+    auto groupSize = [](size_t count, size_t groups, size_t g) {
+        return count / groups + (g < count % groups ? 1 : 0);
+    };
+
+    // Runs of equal keys: distinct key k owns entries [runs[k], runs[k + 1])
+    std::vector<size_t> runs;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i == 0 || entries[i - 1].key < entries[i].key) runs.push_back(i);
+    }
+    runs.push_back(entries.size());
+    std::vector<RID> rids;
+
+    // Level 0: leaves
+    const size_t n = runs.size() - 1;
+    const size_t leaf_count = groupsFor(n, leaf_cap);
+    // Leaves are allocated left to right, so neighbours share slabs
+    std::vector<NodeHandle> level;
+    std::vector<KeyType> low_keys; // smallest key under each node of `level`
+    level.reserve(leaf_count);
+    low_keys.reserve(leaf_count);
+
+    size_t next = 0;
+    Leaf* prev_leaf = nullptr;
+    for (size_t g = 0; g < leaf_count; ++g) {
+        const NodeHandle handle = (g == 0) ? tree.root : tree.newLeaf();
+        Leaf* leaf = &tree.leaf(handle);
+        const size_t take = groupSize(n, leaf_count, g);
+        for (size_t i = 0; i < take; ++i, ++next) {
+            rids.clear();
+            for (size_t e = runs[next]; e < runs[next + 1]; ++e) {
+                rids.push_back(RID::at(entries[e].block_id, entries[e].record_id));
+            }
+            leaf->keys[i] = entries[runs[next]].key;
+            leaf->postings[i].assign(rids.data(), (int)rids.size(), tree.pages);
+        }
+        leaf->key_count = (int)take;
+        if (prev_leaf) prev_leaf->next_leaf = handle;
+        prev_leaf = leaf;
+        level.push_back(handle);
+        low_keys.push_back(leaf->keys[0]);
+    }
+
+    // Internal levels: separator i is the lowest key under child i + 1
+    while (level.size() > 1) {
+        const size_t parent_count = groupsFor(level.size(), child_cap);
+        std::vector<NodeHandle> parents;
+        std::vector<KeyType> parent_lows;
+        parents.reserve(parent_count);
+        parent_lows.reserve(parent_count);
+
+        size_t c = 0;
+        for (size_t g = 0; g < parent_count; ++g) {
+            const NodeHandle handle = tree.newInternal();
+            Internal* parent = &tree.internal(handle);
+            const size_t take = groupSize(level.size(), parent_count, g);
+            parent_lows.push_back(low_keys[c]);
+            for (size_t i = 0; i < take; ++i, ++c) {
+                parent->children[i] = level[c];
+                if (i > 0) parent->keys[i - 1] = low_keys[c];
+            }
+            parent->key_count = (int)take - 1;
+            parents.push_back(handle);
+        }
+        level.swap(parents);
+        low_keys.swap(parent_lows);
+    }
+    tree.root = level.front();
+}
+
+// =============================
+// Search (shared descent + leaf sweep)
+// =============================
+namespace {
+    struct NodeVisitCounters { uint32_t internal = 0, leaf = 0, overflow = 0; };
+
+    // Handle of the only leaf that can hold key, counting internal nodes passed
+    template<typename T, int F>
+    NodeHandle descend(const BPlusTree<T, F>& tree, const T& key, uint32_t* internal_visits = nullptr) {
+        NodeHandle h = tree.root;
+        while (!tree.isLeaf(h)) {
+            if (internal_visits) (*internal_visits)++;
+            const BPlusTreeInternal<T, F>& n = tree.internal(h);
+            h = n.children[n.childIndex(key)];
+        }
+        return h;
+    }
+
+    // Descends to the only leaf that can hold min_key (keys equal to a
+    // separator live to its right), binary-searches the first slot >= min_key,
+    // then follows next_leaf collecting postings until a key exceeds max_key.
+    // Equality is the min_key == max_key case.
+    template<typename T, int F>
+    void sweepRange(const BPlusTree<T, F>& tree, const T& min_key, const T& max_key,
+                    std::vector<std::pair<int,int>>& out, NodeVisitCounters* c = nullptr) {
+        if (tree.root == NULL_NODE || max_key < min_key) return;
+        const BPlusTreeLeaf<T, F>* leaf = &tree.leaf(descend(tree, min_key, c ? &c->internal : nullptr));
+
+        for (int i = leaf->keyIndex(min_key);; i = 0) {
+            if (c) c->leaf++;
+            for (; i < leaf->key_count; ++i) {
+                if (max_key < leaf->keys[i]) return; // leaves are globally ordered
+                const PostingList& pl = leaf->postings[i];
+                pl.appendTo(out);
+                if (c) c->overflow += (uint32_t)pl.pageCount();
+            }
+            if (leaf->next_leaf == NULL_NODE) return;
+            leaf = &tree.leaf(leaf->next_leaf);
+        }
+    }
+}
+
+namespace {
+    // sweepRange() as a resumable state machine: position = (leaf, slot,
+    // overflow page, offset within the inline RIDs or that page)
+    template<typename T, int F>
+    class LeafCursor : public RidCursor {
+    public:
+        LeafCursor(const BPlusTree<T, F>& tree, const T& min_key, const T& max_key)
+            : tree(tree), leaf(nullptr), slot(0), max_key(max_key), page(nullptr), pos(0) {
+            if (tree.root == NULL_NODE || max_key < min_key) return;
+            leaf = &tree.leaf(descend(tree, min_key));
+            slot = leaf->keyIndex(min_key);
+        }
+
+        size_t next(std::pair<int, int>* out, size_t max) override {
+            size_t n = 0;
+            while (n < max && leaf) {
+                if (slot >= leaf->key_count) {
+                    const NodeHandle next_leaf = leaf->next_leaf;
+                    leaf = next_leaf == NULL_NODE ? nullptr : &tree.leaf(next_leaf);
+                    slot = 0;
+                    continue;
+                }
+                if (max_key < leaf->keys[slot]) {
+                    leaf = nullptr; // past the range
+                    break;
+                }
+                const PostingList& pl = leaf->postings[slot];
+                if (!pl.isOverflow()) {
+                    for (; n < max && pos < pl.count; ++pos) emit(out[n++], pl.inline_rids[pos]);
+                    if (pos < pl.count) break;
+                } else {
+                    if (!page) page = pl.overflow; // list not started yet
+                    while (n < max && page) {
+                        for (; n < max && pos < page->count; ++pos) emit(out[n++], page->rids[pos]);
+                        if (pos < page->count) break;
+                        page = page->next;
+                        pos = 0;
+                    }
+                    if (page) break;
+                }
+                slot++;
+                pos = 0;
+            }
+            return n;
+        }
+
+    private:
+        const BPlusTree<T, F>& tree;
+        const BPlusTreeLeaf<T, F>* leaf; // null once exhausted
+        int slot;
+        T max_key;
+        const PostingPage* page; // current overflow page, null before the list starts
+        int pos;
+
+        static void emit(std::pair<int, int>& out, const RID& r) { out = {r.blockId(), r.recordId()}; }
+    };
+
+    template<typename T, int F>
+    std::unique_ptr<RidCursor> openCursor(const BPlusTree<T, F>& tree, const T& min_key, const T& max_key) {
+        return std::unique_ptr<RidCursor>(new LeafCursor<T, F>(tree, min_key, max_key));
+    }
+}
+
+template<typename KeyType, int Fanout>
+std::vector<std::pair<int, int>> IndexManager::search(const BPlusTree<KeyType, Fanout>& tree, KeyType key)
+{
+    std::vector<std::pair<int, int>> results;
+    sweepRange(tree, key, key, results);
     return results;
 }
 
-// Note: Simple rangeSearch (fine for Task 2 demo).
-template<typename KeyType>
-std::vector<std::pair<int,int>> IndexManager::rangeSearch(BPlusTreeNode<KeyType>* root,
+template<typename KeyType, int Fanout>
+std::vector<std::pair<int,int>> IndexManager::rangeSearch(const BPlusTree<KeyType, Fanout>& tree,
                           KeyType min_key, KeyType max_key)
 {
     std::vector<std::pair<int,int>> results;
-    if (!root) return results;
-
-    // 1) Descend to the first leaf that may contain min_key.
-    BPlusTreeNode<KeyType>* node = root;
-    while (node && !node->is_leaf) {
-        int i = 0;
-        // find first separator > min_key (i.e., lower_bound)
-        while (i < node->key_count && min_key > node->keys[i]) ++i;
-        node = node->children[i]; // 0..key_count
-    }
-    if (!node) return results;
-
-    // 2) Scan forward across leaves, stopping when keys exceed max_key.
-    for (auto leaf = node; leaf != nullptr; leaf = leaf->leaf_data.next_leaf) {
-        for (int i = 0; i < leaf->key_count; ++i) {
-            const KeyType k = leaf->keys[i];
-            if (k < min_key) continue;
-            if (k > max_key) return results; // we can stop entirely
-            results.push_back({ leaf->leaf_data.block_ids[i],
-                            leaf->leaf_data.record_ids[i] });
-        }
-    }
+    sweepRange(tree, min_key, max_key, results);
     return results;
 }
 
@@ -297,7 +933,16 @@ std::vector<std::pair<int, int>> IndexManager::searchByFGPercentage(float min_pc
 
 std::vector<std::pair<int, int>> IndexManager::searchByDate(const std::string& date)
 {
-    return search(date_index, date);
+    const int key = Utils::parseDateKey(date);
+    if (key == 0) return {};
+    return searchByDateRange(key, key);
+}
+
+std::vector<std::pair<int, int>> IndexManager::searchByDateRange(int first_key, int last_key)
+{
+    DayCode first, last;
+    DayCode::range(first_key, last_key, first, last);
+    return rangeSearch(date_index, first, last);
 }
 
 std::vector<std::pair<int, int>> IndexManager::searchByFTPercentage(float min_pct, float max_pct)
@@ -305,63 +950,201 @@ std::vector<std::pair<int, int>> IndexManager::searchByFTPercentage(float min_pc
     return rangeSearch(ft_pct_index, min_pct, max_pct);
 }
 
+std::vector<std::pair<int, int>> IndexManager::searchByTeamAndDateRange(int team_id, int first_key, int last_key)
+{
+    return rangeSearch(team_date_index, TeamDateKey{team_id, first_key}, TeamDateKey{team_id, last_key});
+}
+
+std::vector<std::pair<int, int>> IndexManager::searchByTeamInDateOrder(int team_id)
+{
+    return rangeSearch(team_date_index, TeamDateKey::prefixLow(team_id), TeamDateKey::prefixHigh(team_id));
+}
+
+std::unique_ptr<RidCursor> IndexManager::cursorByTeamId(int team_id) const
+{
+    return openCursor(team_id_index, team_id, team_id);
+}
+
+std::unique_ptr<RidCursor> IndexManager::cursorByPointsRange(int min_pts, int max_pts) const
+{
+    return openCursor(points_index, min_pts, max_pts);
+}
+
+std::unique_ptr<RidCursor> IndexManager::cursorByFGPercentage(float min_pct, float max_pct) const
+{
+    return openCursor(fg_pct_index, min_pct, max_pct);
+}
+
+std::unique_ptr<RidCursor> IndexManager::cursorByFTPercentage(float min_pct, float max_pct) const
+{
+    return openCursor(ft_pct_index, min_pct, max_pct);
+}
+
+std::unique_ptr<RidCursor> IndexManager::cursorByDateRange(int first_key, int last_key) const
+{
+    DayCode first, last;
+    DayCode::range(first_key, last_key, first, last);
+    return openCursor(date_index, first, last);
+}
+
+std::unique_ptr<RidCursor> IndexManager::cursorByTeamAndDateRange(int team_id, int first_key, int last_key) const
+{
+    return openCursor(team_date_index, TeamDateKey{team_id, first_key}, TeamDateKey{team_id, last_key});
+}
+
+// Same descent and sweep as sweepRange(), but only keys and posting counts are read
+CoveredStats IndexManager::aggregateByFTPercentage(float min_pct, float max_pct) const
+{
+    CoveredStats st;
+    if (ft_cover_index.root == NULL_NODE || max_pct < min_pct) return st;
+    const FTCoveringKey lo = FTCoveringKey::prefixLow(min_pct);
+    const FTCoveringKey hi = FTCoveringKey::prefixHigh(max_pct);
+
+    const BPlusTreeLeaf<FTCoveringKey>* leaf = &ft_cover_index.leaf(descend(ft_cover_index, lo, &st.nInternal));
+    for (int i = leaf->keyIndex(lo);; i = 0) {
+        st.nLeaf++;
+        for (; i < leaf->key_count; ++i) {
+            const FTCoveringKey& k = leaf->keys[i];
+            if (hi < k) return st;
+            const int n = leaf->postings[i].count;
+            st.rows   += (uint64_t)n;
+            st.sumPts += (int64_t)k.second.first * n;
+            if (k.second.second) st.wins += (uint64_t)n;
+        }
+        if (leaf->next_leaf == NULL_NODE) return st;
+        leaf = &ft_cover_index.leaf(leaf->next_leaf);
+    }
+}
+
+bool IndexManager::removeRecord(const GameRecord& record, int block_id, int record_id)
+{
+    // Non-short-circuit: every index drops the RID even if one lacked it
+    bool ok = remove(team_id_index, record.team_id_home, block_id, record_id);
+    ok = remove(points_index, record.pts_home,     block_id, record_id) && ok;
+    ok = remove(fg_pct_index, record.fg_pct_home,  block_id, record_id) && ok;
+    ok = remove(date_index,   DayCode::fromDateKey(record.game_date), block_id, record_id) && ok;
+    ok = remove(ft_pct_index, record.ft_pct_home,  block_id, record_id) && ok;
+    ok = remove(team_date_index, TeamDateKey{record.team_id_home, record.game_date}, block_id, record_id) && ok;
+    ok = remove(ft_cover_index, coveringKey(record), block_id, record_id) && ok;
+    return ok;
+}
+
+bool IndexManager::checkIntegrity() const
+{
+    bool ok = checkTree("Team ID", team_id_index);
+    ok = checkTree("Points",        points_index) && ok;
+    ok = checkTree("FG Percentage", fg_pct_index) && ok;
+    ok = checkTree("Date",          date_index) && ok;
+    ok = checkTree("FT Percentage", ft_pct_index) && ok;
+    ok = checkTree("Team + Date",   team_date_index) && ok;
+    ok = checkTree("FT% covering",  ft_cover_index) && ok;
+    return ok;
+}
+
+// =============================
+// Standalone trees (fanout sweeps)
+// =============================
+template<typename KeyType, int Fanout>
+BPlusTree<KeyType, Fanout> IndexManager::buildTree(std::vector<IndexEntry<KeyType>> entries, bool bulk_load)
+{
+    BPlusTree<KeyType, Fanout> tree;
+    if (bulk_load) {
+        bulkLoad(tree, entries, 1.0f);
+        return tree;
+    }
+    tree.root = tree.newLeaf();
+    for (const auto& e : entries) insert(tree, e.key, e.block_id, e.record_id);
+    return tree;
+}
+
+// Point lookup without materializing RIDs: the key's posting list, or null
+template<typename KeyType, int Fanout>
+const PostingList* IndexManager::findKey(const BPlusTree<KeyType, Fanout>& tree, const KeyType& key) const
+{
+    if (tree.root == NULL_NODE) return nullptr;
+    const BPlusTreeLeaf<KeyType, Fanout>& leaf = tree.leaf(descend(tree, key));
+    const int i = leaf.keyIndex(key);
+    return (i < leaf.key_count && !(key < leaf.keys[i])) ? &leaf.postings[i] : nullptr;
+}
+
+template<typename KeyType, int Fanout>
+void IndexManager::treeShape(const BPlusTree<KeyType, Fanout>& tree, int& height, int& nodes) const
+{
+    height = getTreeHeight(tree);
+    nodes  = countNodes(tree);
+}
+
 // =============================
 // Stats printing (existing)
 // =============================
-template<typename KeyType>
-int IndexManager::countNodes(BPlusTreeNode<KeyType>* root) const
-{
-    if (!root) return 0;
-    int count = 1;
-    if (!root->is_leaf) {
-        for (int i = 0; i <= root->key_count; i++) {
-            if (root->children[i]) count += countNodes(root->children[i]);
+namespace {
+    // Calls fn(handle, depth) for every node reachable from the root, depth 1 at the root
+    template<typename KeyType, int Fanout, typename Fn>
+    void forEachNode(const BPlusTree<KeyType, Fanout>& tree, Fn fn) {
+        if (tree.root == NULL_NODE) return;
+        std::vector<std::pair<NodeHandle, int>> stack{{tree.root, 1}};
+        while (!stack.empty()) {
+            const std::pair<NodeHandle, int> top = stack.back();
+            stack.pop_back();
+            fn(top.first, top.second);
+            if (tree.isLeaf(top.first)) continue;
+            const BPlusTreeInternal<KeyType, Fanout>& n = tree.internal(top.first);
+            for (int i = 0; i <= n.key_count; i++) {
+                if (n.children[i] != NULL_NODE) stack.push_back({n.children[i], top.second + 1});
+            }
         }
     }
+}
+
+template<typename KeyType, int Fanout>
+int IndexManager::countNodes(const BPlusTree<KeyType, Fanout>& tree) const
+{
+    int count = 0;
+    forEachNode(tree, [&](NodeHandle, int) { count++; });
     return count;
 }
 
-template<typename KeyType>
-int IndexManager::countLeafNodes(BPlusTreeNode<KeyType>* root) const
+template<typename KeyType, int Fanout>
+int IndexManager::countLeafNodes(const BPlusTree<KeyType, Fanout>& tree) const
 {
-    if (!root) return 0;
-    if (root->is_leaf) return 1;
     int count = 0;
-    for (int i = 0; i <= root->key_count; i++) {
-        if (root->children[i]) count += countLeafNodes(root->children[i]);
-    }
+    forEachNode(tree, [&](NodeHandle h, int) { count += tree.isLeaf(h) ? 1 : 0; });
     return count;
 }
 
-template<typename KeyType>
-int IndexManager::getTreeHeight(BPlusTreeNode<KeyType>* root) const
+template<typename KeyType, int Fanout>
+int IndexManager::getTreeHeight(const BPlusTree<KeyType, Fanout>& tree) const
 {
-    if (!root) return 0;
-    if (root->is_leaf) return 1;
     int max_height = 0;
-    for (int i = 0; i <= root->key_count; i++) {
-        if (root->children[i]) {
-            max_height = std::max(max_height, getTreeHeight(root->children[i]));
-        }
-    }
-    return max_height + 1;
+    forEachNode(tree, [&](NodeHandle, int depth) {
+        if (depth > max_height) max_height = depth;
+    });
+    return max_height;
 }
 
-template<typename KeyType>
-int IndexManager::getTotalKeys(BPlusTreeNode<KeyType>* root) const
+template<typename KeyType, int Fanout>
+int IndexManager::getTotalKeys(const BPlusTree<KeyType, Fanout>& tree) const
 {
-    if (!root) return 0;
-    int count = root->key_count;
-    if (!root->is_leaf) {
-        for (int i = 0; i <= root->key_count; i++) {
-            if (root->children[i]) count += getTotalKeys(root->children[i]);
-        }
-    }
+    int count = 0;
+    forEachNode(tree, [&](NodeHandle h, int) { count += tree.node(h).key_count; });
     return count;
 }
 
-template<typename KeyType>
-static void printRootKeysLine(const std::string& index_name, BPlusTreeNode<KeyType>* root) {
+template<typename KeyType, int Fanout>
+void IndexManager::countPostings(const BPlusTree<KeyType, Fanout>& tree, size_t& rids, size_t& pages) const
+{
+    forEachNode(tree, [&](NodeHandle h, int) {
+        if (!tree.isLeaf(h)) return;
+        const BPlusTreeLeaf<KeyType, Fanout>& leaf = tree.leaf(h);
+        for (int i = 0; i < leaf.key_count; i++) {
+            rids  += (size_t)leaf.postings[i].count;
+            pages += leaf.postings[i].pageCount();
+        }
+    });
+}
+
+template<typename KeyType, int Fanout>
+static void printRootKeysLine(const std::string& index_name, const BPlusTreeNode<KeyType, Fanout>* root) {
     (void)index_name; // silence unused-parameter warning
 
     std::cout << "  - Root keys (" << (root ? root->key_count : 0) << "): ";
@@ -388,37 +1171,57 @@ static void printRootKeysLine(const std::string& index_name, BPlusTreeNode<KeyTy
 
 void IndexManager::displayIndexStatistics() const
 {
-    std::cout << "\n=== B+ Tree Index Statistics (Max 20 keys per node) ===" << std::endl;
+    std::cout << "\n=== B+ Tree Index Statistics ===" << std::endl;
 
     displaySingleIndexStats("Team ID",        team_id_index);
     displaySingleIndexStats("Points",         points_index);
     displaySingleIndexStats("FG Percentage",  fg_pct_index);
     displaySingleIndexStats("Date",           date_index);
     displaySingleIndexStats("FT Percentage",  ft_pct_index);
+    displaySingleIndexStats("Team + Date",    team_date_index);
+    displaySingleIndexStats("FT% covering",   ft_cover_index);
 
     int total_nodes =
         countNodes(team_id_index) + countNodes(points_index) +
         countNodes(fg_pct_index)  + countNodes(date_index) +
-        countNodes(ft_pct_index);
+        countNodes(ft_pct_index)  + countNodes(team_date_index) +
+        countNodes(ft_cover_index);
+    // Leaves and internal nodes differ in size, and both per key type
+    size_t node_bytes =
+        team_id_index.nodeBytes() + points_index.nodeBytes() + fg_pct_index.nodeBytes() +
+        date_index.nodeBytes()    + ft_pct_index.nodeBytes() + team_date_index.nodeBytes() +
+        ft_cover_index.nodeBytes();
+    size_t rids = 0, pages = 0;
+    countPostings(team_id_index, rids, pages);
+    countPostings(points_index,  rids, pages);
+    countPostings(fg_pct_index,  rids, pages);
+    countPostings(date_index,    rids, pages);
+    countPostings(ft_pct_index,  rids, pages);
+    countPostings(team_date_index, rids, pages);
+    countPostings(ft_cover_index,  rids, pages);
 
     std::cout << "\nOverall Index Statistics:" << std::endl;
     std::cout << "Total index nodes: " << total_nodes << std::endl;
-    std::cout << "Memory usage estimate: " << (total_nodes * sizeof(BPlusTreeNode<int>)) << " bytes" << std::endl;
+    std::cout << "Total overflow pages: " << pages << std::endl;
+    std::cout << "Memory usage estimate: "
+              << (node_bytes + pages * sizeof(PostingPage)) << " bytes" << std::endl;
 }
 
-template<typename KeyType>
-void IndexManager::displaySingleIndexStats(const std::string& index_name, BPlusTreeNode<KeyType>* root) const
+template<typename KeyType, int Fanout>
+void IndexManager::displaySingleIndexStats(const std::string& index_name, const BPlusTree<KeyType, Fanout>& tree) const
 {
-    if (!root) {
+    if (tree.root == NULL_NODE) {
         std::cout << index_name << " Index: Not initialized" << std::endl;
         return;
     }
 
-    int total_nodes    = countNodes(root);
-    int leaf_nodes     = countLeafNodes(root);
+    int total_nodes    = countNodes(tree);
+    int leaf_nodes     = countLeafNodes(tree);
     int internal_nodes = total_nodes - leaf_nodes;
-    int tree_height    = getTreeHeight(root);
-    int total_keys     = getTotalKeys(root);
+    int tree_height    = getTreeHeight(tree);
+    int total_keys     = getTotalKeys(tree);
+    size_t rids = 0, pages = 0;
+    countPostings(tree, rids, pages);
 
     std::cout << "\n" << index_name << " Index:" << std::endl;
     std::cout << "  - Total nodes: "    << total_nodes    << std::endl;
@@ -426,98 +1229,453 @@ void IndexManager::displaySingleIndexStats(const std::string& index_name, BPlusT
     std::cout << "  - Internal nodes: " << internal_nodes << std::endl;
     std::cout << "  - Tree height: "    << tree_height    << std::endl;
     std::cout << "  - Total keys: "     << total_keys     << std::endl;
-    std::cout << "  - Max keys per node: " << BPlusTreeNode<KeyType>::MAX_KEYS << std::endl;
+    std::cout << "  - Total RIDs: "     << rids           << std::endl;
+    std::cout << "  - Overflow pages: " << pages          << std::endl;
+    std::cout << "  - Max keys per node: " << BPlusTreeNode<KeyType, Fanout>::MAX_KEYS << std::endl;
     if (leaf_nodes > 0) {
         std::cout << "  - Avg keys per leaf: " << (total_keys / leaf_nodes) << std::endl;
     }
-    printRootKeysLine(index_name, root);
+    printRootKeysLine(index_name, &tree.node(tree.root));
 }
 
-// ==========================================
-// Task 3 — counts-aware FT% leaf sweep + rebuild
-// ==========================================
+// =============================
+// Paged index files
+// =============================
+// Page 0 is a header, then one page per node (breadth-first), then the
+// posting-list overflow pages. Children, next_leaf and overflow chains are
+// stored as page IDs (0 = none, since page 0 is never a node). RIDs are
+// written as their 64-bit locators. The header also records the heap's
+// record and block counts; a file built over other data is refused.
+//
+//   header   : magic[8] | key_tag | key_width | max_keys | page_count | root_page
+//              | reserved | record_count (uint64) | block_count (uint64)
+//   node     : kind | key_count | next | keys[key_count]
+//              | children[key_count + 1]                                (internal)
+//              | per key: rid_count | INLINE_RIDS RIDs, or the first
+//                overflow page ID when rid_count > INLINE_RIDS          (leaf)
+//   overflow : kind | rid_count | next | rids[rid_count]
 namespace {
-    struct NodeVisitCounters { uint32_t internal = 0, leaf = 0; };
-
-    template<typename T>
-    BPlusTreeNode<T>* descendToFirstLeafWithCounts(BPlusTreeNode<T>* root,
-                                                   const T& min_key,
-                                                   NodeVisitCounters& c) {
-        auto* cur = root;
-        while (cur && !cur->is_leaf) {
-            c.internal++;
-            int pos = 0;
-            while (pos < cur->key_count && min_key > cur->keys[pos]) ++pos;
-            cur = cur->children[pos];
+    const char INDEX_MAGIC[8] = {'N', 'B', 'A', 'I', 'D', 'X', '4', '\0'};
+
+    enum IndexPageKind : int32_t { PAGE_INTERNAL = 0, PAGE_LEAF = 1, PAGE_OVERFLOW = 2 };
+
+    struct IndexFileHeader {
+        char    magic[8];
+        int32_t key_tag;
+        int32_t key_width;
+        int32_t max_keys;
+        int32_t page_count;
+        int32_t root_page;
+        int32_t reserved;
+        uint64_t record_count; // heap the index was built over
+        uint64_t block_count;
+    };
+
+    struct IndexPageHeader {
+        int32_t kind;
+        int32_t count; // keys, or RIDs on an overflow page
+        int32_t next;  // next leaf / next overflow page
+    };
+
+    const size_t POSTING_SLOT_BYTES = sizeof(int32_t) + PostingList::INLINE_RIDS * sizeof(RID);
+
+    // Fixed-width on-page encoding for each key type
+    template<typename KeyType> struct IndexKeyCodec;
+
+    template<> struct IndexKeyCodec<int> {
+        static const int32_t TAG = 1;
+        static const int32_t WIDTH = sizeof(int32_t);
+        static void encode(const int& k, char* out) { std::memcpy(out, &k, WIDTH); }
+        static int decode(const char* in) { int k; std::memcpy(&k, in, WIDTH); return k; }
+    };
+
+    template<> struct IndexKeyCodec<float> {
+        static const int32_t TAG = 2;
+        static const int32_t WIDTH = sizeof(float);
+        static void encode(const float& k, char* out) { std::memcpy(out, &k, WIDTH); }
+        static float decode(const char* in) { float k; std::memcpy(&k, in, WIDTH); return k; }
+    };
+
+    template<> struct IndexKeyCodec<bool> {
+        static const int32_t TAG = 3;
+        static const int32_t WIDTH = 1;
+        static void encode(const bool& k, char* out) { *out = k ? 1 : 0; }
+        static bool decode(const char* in) { return *in != 0; }
+    };
+
+    template<> struct IndexKeyCodec<DayCode> {
+        static const int32_t TAG = 4;
+        static const int32_t WIDTH = sizeof(uint16_t);
+        static void encode(const DayCode& k, char* out) { std::memcpy(out, &k.code, WIDTH); }
+        static DayCode decode(const char* in) { DayCode k; std::memcpy(&k.code, in, WIDTH); return k; }
+    };
+
+    // Both columns in order, each as its own codec writes it; the tag nests
+    // the column tags (one byte each) above a composite marker
+    template<typename First, typename Second> struct IndexKeyCodec<CompositeKey<First, Second>> {
+        typedef IndexKeyCodec<First> A;
+        typedef IndexKeyCodec<Second> B;
+        static const int32_t TAG = 0x40 | ((A::TAG & 0xff) << 8) | ((B::TAG & 0xff) << 16);
+        static const int32_t WIDTH = A::WIDTH + B::WIDTH;
+        static void encode(const CompositeKey<First, Second>& k, char* out) {
+            A::encode(k.first, out);
+            B::encode(k.second, out + A::WIDTH);
+        }
+        static CompositeKey<First, Second> decode(const char* in) {
+            return CompositeKey<First, Second>{A::decode(in), B::decode(in + A::WIDTH)};
+        }
+    };
+
+    template<typename KeyType, int Fanout>
+    constexpr size_t nodePageBytes() {
+        using Node = BPlusTreeNode<KeyType, Fanout>;
+        return sizeof(IndexPageHeader) + Node::MAX_KEYS * IndexKeyCodec<KeyType>::WIDTH +
+               std::max<size_t>((Node::MAX_KEYS + 1) * sizeof(int32_t), Node::MAX_KEYS * POSTING_SLOT_BYTES);
+    }
+}
+
+template<typename KeyType, int Fanout>
+bool IndexManager::savePagedIndex(const std::string& path, const BPlusTree<KeyType, Fanout>& tree,
+                                  uint64_t record_count, uint64_t block_count) const
+{
+    using Node  = BPlusTreeNode<KeyType, Fanout>;
+    using Codec = IndexKeyCodec<KeyType>;
+    static_assert(nodePageBytes<KeyType, Fanout>() <= INDEX_PAGE_SIZE, "B+ tree node does not fit one index page");
+    static_assert(sizeof(IndexPageHeader) + PostingPage::CAPACITY * sizeof(RID) <= INDEX_PAGE_SIZE,
+                  "overflow page does not fit one index page");
+
+    // Number nodes level by level; leaves end up contiguous and left-to-right
+    std::vector<NodeHandle> order;
+    std::unordered_map<NodeHandle, int32_t> page_of;
+    if (tree.root != NULL_NODE) {
+        order.push_back(tree.root);
+        for (size_t i = 0; i < order.size(); ++i) {
+            page_of[order[i]] = (int32_t)i + 1;
+            if (tree.isLeaf(order[i])) continue;
+            const BPlusTreeInternal<KeyType, Fanout>& n = tree.internal(order[i]);
+            for (int c = 0; c <= n.key_count; ++c) {
+                if (n.children[c] != NULL_NODE) order.push_back(n.children[c]);
+            }
+        }
+    }
+
+    // Overflow pages follow the nodes, chain by chain in key order
+    std::vector<const PostingPage*> overflow;
+    std::unordered_map<const PostingPage*, int32_t> overflow_page_of;
+    for (NodeHandle h : order) {
+        if (!tree.isLeaf(h)) continue;
+        const BPlusTreeLeaf<KeyType, Fanout>& leaf = tree.leaf(h);
+        for (int i = 0; i < leaf.key_count; ++i) {
+            const PostingList& pl = leaf.postings[i];
+            if (!pl.isOverflow()) continue;
+            for (const PostingPage* p = pl.overflow; p; p = p->next) {
+                overflow.push_back(p);
+                overflow_page_of[p] = (int32_t)(order.size() + overflow.size());
+            }
         }
-        if (cur) c.leaf++;
-        return cur;
-    }
-
-    template<typename T>
-    void sweepRightLeavesWithin(BPlusTreeNode<T>* leaf,
-                                const T& min_key, const T& max_key,
-                                std::vector<std::pair<int,int>>& out,
-                                NodeVisitCounters& c) {
-        for (auto* p = leaf; p; p = p->leaf_data.next_leaf) {
-            if (p != leaf) c.leaf++;
-            for (int i = 0; i < p->key_count; i++) {
-                const T& k = p->keys[i];
-                if (k < min_key) continue;
-                if (k > max_key) return; // leaves are globally ordered
-                out.emplace_back(p->leaf_data.block_ids[i], p->leaf_data.record_ids[i]);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create index file " << path << std::endl;
+        return false;
+    }
+
+    std::vector<char> page(INDEX_PAGE_SIZE, 0);
+    IndexFileHeader hdr{};
+    std::memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.key_tag    = Codec::TAG;
+    hdr.key_width  = Codec::WIDTH;
+    hdr.max_keys   = Node::MAX_KEYS;
+    hdr.page_count = (int32_t)(order.size() + overflow.size()) + 1;
+    hdr.root_page  = tree.root != NULL_NODE ? 1 : 0;
+    hdr.record_count = record_count;
+    hdr.block_count  = block_count;
+    std::memcpy(page.data(), &hdr, sizeof(hdr));
+    out.write(page.data(), page.size());
+
+    auto pageId = [&](NodeHandle h) -> int32_t {
+        auto it = page_of.find(h);
+        return it == page_of.end() ? 0 : it->second;
+    };
+
+    for (NodeHandle h : order) {
+        const Node* n = &tree.node(h);
+        const bool is_leaf = tree.isLeaf(h);
+        std::fill(page.begin(), page.end(), 0);
+        IndexPageHeader ph{};
+        ph.kind  = is_leaf ? PAGE_LEAF : PAGE_INTERNAL;
+        ph.count = n->key_count;
+        ph.next  = is_leaf ? pageId(tree.leaf(h).next_leaf) : 0;
+        std::memcpy(page.data(), &ph, sizeof(ph));
+
+        char* p = page.data() + sizeof(ph);
+        for (int i = 0; i < n->key_count; ++i, p += Codec::WIDTH) Codec::encode(n->keys[i], p);
+
+        if (is_leaf) {
+            for (int i = 0; i < n->key_count; ++i, p += POSTING_SLOT_BYTES) {
+                const PostingList& pl = tree.leaf(h).postings[i];
+                std::memcpy(p, &pl.count, sizeof(int32_t));
+                if (pl.isOverflow()) {
+                    const int32_t first = overflow_page_of[pl.overflow];
+                    std::memcpy(p + sizeof(int32_t), &first, sizeof(first));
+                } else {
+                    std::memcpy(p + sizeof(int32_t), pl.inline_rids, pl.count * sizeof(RID));
+                }
+            }
+        } else {
+            for (int c = 0; c <= n->key_count; ++c, p += sizeof(int32_t)) {
+                int32_t id = pageId(tree.internal(h).children[c]);
+                std::memcpy(p, &id, sizeof(id));
             }
         }
+        out.write(page.data(), page.size());
     }
+
+    for (const PostingPage* op : overflow) {
+        std::fill(page.begin(), page.end(), 0);
+        IndexPageHeader ph{};
+        ph.kind  = PAGE_OVERFLOW;
+        ph.count = op->count;
+        ph.next  = op->next ? overflow_page_of[op->next] : 0;
+        std::memcpy(page.data(), &ph, sizeof(ph));
+        std::memcpy(page.data() + sizeof(ph), op->rids, op->count * sizeof(RID));
+        out.write(page.data(), page.size());
+    }
+
+    out.close();
+    return !out.fail();
 }
 
+template<typename KeyType, int Fanout>
+bool IndexManager::loadPagedIndex(const std::string& path, BPlusTree<KeyType, Fanout>& tree,
+                                  uint64_t record_count, uint64_t block_count)
+{
+    using Node  = BPlusTreeNode<KeyType, Fanout>;
+    using Codec = IndexKeyCodec<KeyType>;
+
+    std::ifstream in(path, std::ios::binary | std::ios::in);
+    if (!in.is_open()) {
+        std::cerr << "Error: Cannot open index file " << path << std::endl;
+        return false;
+    }
+
+    std::vector<char> page(INDEX_PAGE_SIZE);
+    IndexFileHeader hdr{};
+    if (!in.read(page.data(), page.size())) {
+        std::cerr << "Error: Truncated index file " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&hdr, page.data(), sizeof(hdr));
+    if (std::memcmp(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.key_tag != Codec::TAG || hdr.key_width != Codec::WIDTH ||
+        hdr.max_keys != Node::MAX_KEYS || hdr.page_count < 1) {
+        std::cerr << "Error: Incompatible index file " << path << std::endl;
+        return false;
+    }
+    if (hdr.record_count != record_count || hdr.block_count != block_count) {
+        std::cerr << "Error: Index file " << path << " was built over " << hdr.record_count << " records in "
+                  << hdr.block_count << " blocks, not the " << record_count << " records in " << block_count
+                  << " blocks now open" << std::endl;
+        return false;
+    }
+
+    // One pass to materialise nodes and overflow pages into a fresh tree, then
+    // patch page IDs into handles and pointers. Overflowing postings stay
+    // empty until their chain checks out.
+    struct OverflowRef { BPlusTreeLeaf<KeyType, Fanout>* leaf; int slot; int32_t rid_count; int32_t first_page; };
+    const int32_t pages = hdr.page_count - 1;
+    BPlusTree<KeyType, Fanout> loaded;
+    std::vector<NodeHandle> by_page(hdr.page_count, NULL_NODE);
+    std::vector<PostingPage*> overflow_at(hdr.page_count, nullptr);
+    std::vector<int32_t> links; // per page: next, or children[0..key_count]
+    std::vector<size_t> link_start(hdr.page_count, 0);
+    std::vector<OverflowRef> overflow_refs;
+
+    bool ok = true;
+    for (int32_t id = 1; id <= pages && ok; ++id) {
+        if (!in.read(page.data(), page.size())) { ok = false; break; }
+        IndexPageHeader ph{};
+        std::memcpy(&ph, page.data(), sizeof(ph));
+        const char* p = page.data() + sizeof(ph);
+        link_start[id] = links.size();
+
+        if (ph.kind == PAGE_OVERFLOW) {
+            if (ph.count < 1 || ph.count > PostingPage::CAPACITY) { ok = false; break; }
+            PostingPage* op = loaded.pages.allocate();
+            overflow_at[id] = op;
+            op->count = ph.count;
+            op->next = nullptr;
+            std::memcpy(op->rids, p, op->count * sizeof(RID));
+            links.push_back(ph.next);
+            continue;
+        }
+        if ((ph.kind != PAGE_LEAF && ph.kind != PAGE_INTERNAL) ||
+            ph.count < 0 || ph.count > Node::MAX_KEYS) { ok = false; break; }
+
+        const bool is_leaf = ph.kind == PAGE_LEAF;
+        by_page[id] = is_leaf ? loaded.newLeaf() : loaded.newInternal();
+        Node* n = &loaded.node(by_page[id]);
+        n->key_count = ph.count;
+        for (int i = 0; i < n->key_count; ++i, p += Codec::WIDTH) n->keys[i] = Codec::decode(p);
+
+        if (is_leaf) {
+            for (int i = 0; i < n->key_count && ok; ++i, p += POSTING_SLOT_BYTES) {
+                PostingList& pl = loaded.leaf(by_page[id]).postings[i];
+                int32_t rid_count;
+                std::memcpy(&rid_count, p, sizeof(rid_count));
+                if (rid_count < 1) { ok = false; break; }
+                if (rid_count <= PostingList::INLINE_RIDS) {
+                    pl.count = rid_count;
+                    std::memcpy(pl.inline_rids, p + sizeof(int32_t), rid_count * sizeof(RID));
+                } else {
+                    int32_t first;
+                    std::memcpy(&first, p + sizeof(int32_t), sizeof(first));
+                    overflow_refs.push_back({&loaded.leaf(by_page[id]), i, rid_count, first});
+                }
+            }
+            links.push_back(ph.next);
+        } else {
+            for (int c = 0; c <= n->key_count; ++c, p += sizeof(int32_t)) {
+                int32_t child;
+                std::memcpy(&child, p, sizeof(child));
+                links.push_back(child);
+            }
+        }
+    }
+
+    auto nodeAt = [&](int32_t id) -> NodeHandle {
+        if (id <= 0 || id > pages) return NULL_NODE;
+        return by_page[id];
+    };
+    auto overflowAt = [&](int32_t id) -> PostingPage* {
+        if (id <= 0 || id > pages) return nullptr;
+        return overflow_at[id];
+    };
+
+    // Every chain must be made of unshared overflow pages adding up to its count
+    std::vector<uint8_t> claimed(hdr.page_count, 0);
+    for (const OverflowRef& ref : overflow_refs) {
+        if (!ok) break;
+        int32_t total = 0;
+        for (int32_t id = ref.first_page; id != 0 && ok; id = links[link_start[id]]) {
+            if (!overflowAt(id) || claimed[id]) { ok = false; break; }
+            claimed[id] = 1;
+            total += overflow_at[id]->count;
+        }
+        if (total != ref.rid_count) ok = false;
+    }
+    for (int32_t id = 1; id <= pages && ok; ++id) {
+        if (overflow_at[id] && !claimed[id]) ok = false; // orphaned page
+    }
+
+    if (ok) {
+        for (int32_t id = 1; id <= pages; ++id) {
+            const int32_t* l = links.data() + link_start[id];
+            if (PostingPage* op = overflow_at[id]) {
+                op->next = overflowAt(l[0]);
+                continue;
+            }
+            const NodeHandle h = by_page[id];
+            if (loaded.isLeaf(h)) {
+                loaded.leaf(h).next_leaf = nodeAt(l[0]);
+            } else {
+                BPlusTreeInternal<KeyType, Fanout>& n = loaded.internal(h);
+                for (int c = 0; c <= n.key_count; ++c) n.children[c] = nodeAt(l[c]);
+            }
+        }
+        for (const OverflowRef& ref : overflow_refs) {
+            PostingList& pl = ref.leaf->postings[ref.slot];
+            pl.count = ref.rid_count;
+            pl.overflow = overflow_at[ref.first_page];
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "Error: Corrupt index file " << path << std::endl;
+        return false; // `loaded` frees its slabs
+    }
+
+    loaded.root = nodeAt(hdr.root_page);
+    if (loaded.root == NULL_NODE) loaded.root = loaded.newLeaf();
+    tree = std::move(loaded);
+    return true;
+}
+
+bool IndexManager::saveIndexes(const std::string& base_path, uint64_t record_count, uint64_t block_count) const
+{
+    const uint64_t r = record_count, b = block_count;
+    return savePagedIndex(base_path + ".team_id.idx", team_id_index, r, b) &&
+           savePagedIndex(base_path + ".points.idx",  points_index,  r, b) &&
+           savePagedIndex(base_path + ".fg_pct.idx",  fg_pct_index,  r, b) &&
+           savePagedIndex(base_path + ".date.idx",    date_index,    r, b) &&
+           savePagedIndex(base_path + ".ft_pct.idx",  ft_pct_index,  r, b) &&
+           savePagedIndex(base_path + ".team_date.idx", team_date_index, r, b) &&
+           savePagedIndex(base_path + ".ft_cover.idx", ft_cover_index, r, b);
+}
+
+bool IndexManager::loadIndexes(const std::string& base_path, uint64_t record_count, uint64_t block_count)
+{
+    const uint64_t r = record_count, b = block_count;
+    return loadPagedIndex(base_path + ".team_id.idx", team_id_index, r, b) &&
+           loadPagedIndex(base_path + ".points.idx",  points_index,  r, b) &&
+           loadPagedIndex(base_path + ".fg_pct.idx",  fg_pct_index,  r, b) &&
+           loadPagedIndex(base_path + ".date.idx",    date_index,    r, b) &&
+           loadPagedIndex(base_path + ".ft_pct.idx",  ft_pct_index,  r, b) &&
+           loadPagedIndex(base_path + ".team_date.idx", team_date_index, r, b) &&
+           loadPagedIndex(base_path + ".ft_cover.idx", ft_cover_index, r, b);
+}
+
+// ==========================================
+// Task 3 — counts-aware FT% leaf sweep + rebuild
+// ==========================================
 std::vector<std::pair<int,int>>
 IndexManager::searchByFTPercentageWithCounts(float min_pct, float max_pct,
-                                             uint32_t& outInternal, uint32_t& outLeaf)
+                                             uint32_t& outInternal, uint32_t& outLeaf,
+                                             uint32_t& outOverflow)
 {
     std::vector<std::pair<int,int>> results;
-    outInternal = outLeaf = 0;
-    if (!ft_pct_index) return results;
+    outInternal = outLeaf = outOverflow = 0;
+    if (ft_pct_index.root == NULL_NODE) return results;
 
     NodeVisitCounters c{};
-    if (ft_pct_index->is_leaf) {
-        c.leaf++;
-        sweepRightLeavesWithin<float>(ft_pct_index, min_pct, max_pct, results, c);
-    } else {
-        auto* firstLeaf = descendToFirstLeafWithCounts<float>(ft_pct_index, min_pct, c);
-        if (firstLeaf) sweepRightLeavesWithin<float>(firstLeaf, min_pct, max_pct, results, c);
-    }
+    sweepRange(ft_pct_index, min_pct, max_pct, results, &c);
     outInternal = c.internal;
     outLeaf = c.leaf;
+    outOverflow = c.overflow;
     return results;
 }
 
-bool IndexManager::buildIndexesSkippingDeleted(const DatabaseFile& db)
-{
-    delete team_id_index; delete points_index; delete fg_pct_index;
-    delete date_index;    delete ft_pct_index;
-    team_id_index = new BPlusTreeNode<int>(true);
-    points_index  = new BPlusTreeNode<int>(true);
-    fg_pct_index  = new BPlusTreeNode<float>(true);
-    date_index    = new BPlusTreeNode<std::string>(true);
-    ft_pct_index  = new BPlusTreeNode<float>(true);
-
-    for (size_t block_idx = 0; block_idx < db.getTotalBlocks(); ++block_idx) {
-        const Block& block = db.getBlock(block_idx);
-        for (int record_idx = 0; record_idx < block.record_count; ++record_idx) {
-            if (db.isDeleted(block_idx, record_idx)) continue; // skip deleted
-            GameRecord r = block.getRecord(record_idx);
-            insert(team_id_index, r.team_id_home,           (int)block_idx, record_idx);
-            insert(points_index,  r.pts_home,               (int)block_idx, record_idx);
-            insert(fg_pct_index,  r.fg_pct_home,            (int)block_idx, record_idx);
-            insert(date_index,    std::string(r.game_date), (int)block_idx, record_idx);
-            insert(ft_pct_index,  r.ft_pct_home,            (int)block_idx, record_idx);
-        }
-    }
-    return true;
+bool IndexManager::buildIndexesSkippingDeleted(const DatabaseFile& db, bool bulk_load,
+                                               float fill_factor)
+{
+    return buildAllIndexes(db, true, bulk_load, fill_factor); // skip deleted
 }
 
-// Explicit instantiation so templates link in this TU
-template struct BPlusTreeNode<int>;
-template struct BPlusTreeNode<float>;
-template struct BPlusTreeNode<std::string>;
+// Explicit instantiation so templates link in this TU: the default
+// (page-sized) fanouts plus the fanouts swept by --bench fanout
+#define NBA_INSTANTIATE_TREE(K, F)                                                                    \
+    template struct BPlusTreeNode<K, F>;                                                              \
+    template struct BPlusTreeLeaf<K, F>;                                                              \
+    template struct BPlusTreeInternal<K, F>;                                                          \
+    template BPlusTree<K, F> IndexManager::buildTree<K, F>(std::vector<IndexEntry<K>>, bool);         \
+    template const PostingList* IndexManager::findKey<K, F>(const BPlusTree<K, F>&, const K&) const;  \
+    template void IndexManager::treeShape<K, F>(const BPlusTree<K, F>&, int&, int&) const;
+
+#define NBA_INSTANTIATE_TREES(K)                                                                      \
+    NBA_INSTANTIATE_TREE(K, IndexFanout<K>::value)                                                    \
+    NBA_INSTANTIATE_TREE(K, 8)   NBA_INSTANTIATE_TREE(K, 16)  NBA_INSTANTIATE_TREE(K, 32)             \
+    NBA_INSTANTIATE_TREE(K, 64)  NBA_INSTANTIATE_TREE(K, 128) NBA_INSTANTIATE_TREE(K, 256)
+
+NBA_INSTANTIATE_TREES(int)
+NBA_INSTANTIATE_TREES(float)
+NBA_INSTANTIATE_TREES(DayCode)
+
+static_assert(sizeof(BPlusTreeLeaf<int>) <= IndexManager::INDEX_PAGE_SIZE &&
+              sizeof(BPlusTreeLeaf<float>) <= IndexManager::INDEX_PAGE_SIZE &&
+              sizeof(BPlusTreeLeaf<DayCode>) <= IndexManager::INDEX_PAGE_SIZE &&
+              sizeof(BPlusTreeLeaf<TeamDateKey>) <= IndexManager::INDEX_PAGE_SIZE &&
+              sizeof(BPlusTreeLeaf<FTCoveringKey>) <= IndexManager::INDEX_PAGE_SIZE,
+              "default fanout must keep a leaf within one index page");
+static_assert(sizeof(RID) == sizeof(uint64_t), "RIDs are stored as 64-bit locators");
+static_assert(IndexFanout<int>::PAGE_BYTES == IndexManager::INDEX_PAGE_SIZE, "fanout page size out of sync");
@@ -0,0 +1,375 @@
+#include "GameRecord.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NBA_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// AVX2 kernels are compiled for AVX2 individually so the rest of the program
+// keeps the baseline ISA; they only run after the runtime CPU check.
+#if defined(NBA_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NBA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NBA_TARGET_AVX2
+#endif
+
+namespace Simd
+{
+    int countTrailingZeros(uint64_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward64(&idx, mask);
+        return (int)idx;
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+
+    namespace
+    {
+        // Appends base + bit index for every set bit of mask
+        inline size_t emitPositions(uint64_t mask, uint32_t base, uint32_t *out, size_t n)
+        {
+            while (mask)
+            {
+                out[n++] = base + (uint32_t)countTrailingZeros(mask);
+                mask &= mask - 1;
+            }
+            return n;
+        }
+
+        size_t findDelimitersScalar(const char *data, size_t len, uint32_t *out, size_t n, size_t from)
+        {
+            for (size_t i = from; i < len; ++i)
+                if (data[i] == '\t' || data[i] == '\n')
+                    out[n++] = (uint32_t)i;
+            return n;
+        }
+
+        // Scalar predicate tail: slots [from, count)
+        template <typename T>
+        void andRangeMaskScalar(const T *values, int from, int count, T lo, T hi, uint64_t *mask)
+        {
+            for (int i = from; i < count; ++i)
+            {
+                T v;
+                std::memcpy(&v, values + i, sizeof(T)); // values may point into raw block bytes
+                if (!(lo <= v && v <= hi))
+                    mask[i >> 6] &= ~(1ULL << (i & 63));
+            }
+        }
+
+        // Clears the slots of an 8-lane group whose bit in `hits` is 0
+        inline void andGroup(uint64_t *mask, int i, unsigned hits, int lanes)
+        {
+            const uint64_t miss = (uint64_t)(~hits & ((1u << lanes) - 1));
+            mask[i >> 6] &= ~(miss << (i & 63));
+        }
+
+        // Sorted-key search tail: keys[from, n) below key (<= when Inclusive)
+        template <bool Inclusive, typename T>
+        int countBelowScalar(const T *keys, int from, int n, T key)
+        {
+            int i = from;
+            while (i < n && (Inclusive ? keys[i] <= key : keys[i] < key))
+                ++i;
+            return i;
+        }
+
+        // Keys are sorted, so the lanes below key form a prefix of the group and
+        // the first group that is not all hits ends the search
+        inline int groupEnd(int i, unsigned hits, int lanes)
+        {
+            return i + countTrailingZeros(~hits & ((1u << lanes) - 1));
+        }
+
+#ifdef NBA_SIMD_X86
+        void andRangeMaskSSE2(const int32_t *values, int count, int32_t lo, int32_t hi, uint64_t *mask)
+        {
+            const __m128i vlo = _mm_set1_epi32(lo);
+            const __m128i vhi = _mm_set1_epi32(hi);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+                __m128i out = _mm_or_si128(_mm_cmpgt_epi32(vlo, v), _mm_cmpgt_epi32(v, vhi));
+                andGroup(mask, i, ~(unsigned)_mm_movemask_ps(_mm_castsi128_ps(out)), 4);
+            }
+            andRangeMaskScalar(values, i, count, lo, hi, mask);
+        }
+
+        void andRangeMaskSSE2(const float *values, int count, float lo, float hi, uint64_t *mask)
+        {
+            const __m128 vlo = _mm_set1_ps(lo);
+            const __m128 vhi = _mm_set1_ps(hi);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 v = _mm_loadu_ps(values + i);
+                __m128 in = _mm_and_ps(_mm_cmpge_ps(v, vlo), _mm_cmple_ps(v, vhi));
+                andGroup(mask, i, (unsigned)_mm_movemask_ps(in), 4);
+            }
+            andRangeMaskScalar(values, i, count, lo, hi, mask);
+        }
+
+        NBA_TARGET_AVX2 void andRangeMaskAVX2(const int32_t *values, int count, int32_t lo, int32_t hi,
+                                              uint64_t *mask)
+        {
+            const __m256i vlo = _mm256_set1_epi32(lo);
+            const __m256i vhi = _mm256_set1_epi32(hi);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+                __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, v), _mm256_cmpgt_epi32(v, vhi));
+                andGroup(mask, i, ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(out)), 8);
+            }
+            andRangeMaskScalar(values, i, count, lo, hi, mask);
+        }
+
+        NBA_TARGET_AVX2 void andRangeMaskAVX2(const float *values, int count, float lo, float hi,
+                                              uint64_t *mask)
+        {
+            const __m256 vlo = _mm256_set1_ps(lo);
+            const __m256 vhi = _mm256_set1_ps(hi);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 v = _mm256_loadu_ps(values + i);
+                __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LE_OQ));
+                andGroup(mask, i, (unsigned)_mm256_movemask_ps(in), 8);
+            }
+            andRangeMaskScalar(values, i, count, lo, hi, mask);
+        }
+
+        template <bool Inclusive>
+        int countBelowSSE2(const int32_t *keys, int n, int32_t key)
+        {
+            const __m128i vkey = _mm_set1_epi32(key);
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+                __m128i hit = Inclusive ? _mm_cmpgt_epi32(v, vkey) : _mm_cmplt_epi32(v, vkey);
+                unsigned hits = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(hit));
+                if (Inclusive)
+                    hits = ~hits & 0xF;
+                if (hits != 0xF)
+                    return groupEnd(i, hits, 4);
+            }
+            return countBelowScalar<Inclusive>(keys, i, n, key);
+        }
+
+        template <bool Inclusive>
+        int countBelowSSE2(const float *keys, int n, float key)
+        {
+            const __m128 vkey = _mm_set1_ps(key);
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128 v = _mm_loadu_ps(keys + i);
+                unsigned hits = (unsigned)_mm_movemask_ps(Inclusive ? _mm_cmple_ps(v, vkey) : _mm_cmplt_ps(v, vkey));
+                if (hits != 0xF)
+                    return groupEnd(i, hits, 4);
+            }
+            return countBelowScalar<Inclusive>(keys, i, n, key);
+        }
+
+        template <bool Inclusive>
+        NBA_TARGET_AVX2 int countBelowAVX2(const int32_t *keys, int n, int32_t key)
+        {
+            const __m256i vkey = _mm256_set1_epi32(key);
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+                __m256i hit = Inclusive ? _mm256_cmpgt_epi32(v, vkey) : _mm256_cmpgt_epi32(vkey, v);
+                unsigned hits = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(hit));
+                if (Inclusive)
+                    hits = ~hits & 0xFF;
+                if (hits != 0xFF)
+                    return groupEnd(i, hits, 8);
+            }
+            return countBelowScalar<Inclusive>(keys, i, n, key);
+        }
+
+        template <bool Inclusive>
+        NBA_TARGET_AVX2 int countBelowAVX2(const float *keys, int n, float key)
+        {
+            const __m256 vkey = _mm256_set1_ps(key);
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256 v = _mm256_loadu_ps(keys + i);
+                __m256 hit = _mm256_cmp_ps(v, vkey, Inclusive ? _CMP_LE_OQ : _CMP_LT_OQ);
+                unsigned hits = (unsigned)_mm256_movemask_ps(hit);
+                if (hits != 0xFF)
+                    return groupEnd(i, hits, 8);
+            }
+            return countBelowScalar<Inclusive>(keys, i, n, key);
+        }
+
+        size_t findDelimitersSSE2(const char *data, size_t len, uint32_t *out)
+        {
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i nl = _mm_set1_epi8('\n');
+            size_t n = 0, i = 0;
+            for (; i + 64 <= len; i += 64)
+            {
+                uint64_t mask = 0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 16 * k));
+                    __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, nl));
+                    mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(hit) << (16 * k);
+                }
+                n = emitPositions(mask, (uint32_t)i, out, n);
+            }
+            return findDelimitersScalar(data, len, out, n, i);
+        }
+
+        NBA_TARGET_AVX2 size_t findDelimitersAVX2(const char *data, size_t len, uint32_t *out)
+        {
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i nl = _mm256_set1_epi8('\n');
+            size_t n = 0, i = 0;
+            for (; i + 64 <= len; i += 64)
+            {
+                __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32));
+                __m256i hit_lo = _mm256_or_si256(_mm256_cmpeq_epi8(lo, tab), _mm256_cmpeq_epi8(lo, nl));
+                __m256i hit_hi = _mm256_or_si256(_mm256_cmpeq_epi8(hi, tab), _mm256_cmpeq_epi8(hi, nl));
+                uint64_t mask = (uint64_t)(uint32_t)_mm256_movemask_epi8(hit_lo) |
+                                ((uint64_t)(uint32_t)_mm256_movemask_epi8(hit_hi) << 32);
+                n = emitPositions(mask, (uint32_t)i, out, n);
+            }
+            return findDelimitersScalar(data, len, out, n, i);
+        }
+
+        bool cpuHasAVX2()
+        {
+#if defined(_MSC_VER)
+            int regs[4];
+            __cpuid(regs, 0);
+            if (regs[0] < 7)
+                return false;
+            __cpuidex(regs, 7, 0);
+            const bool avx2 = (regs[1] & (1 << 5)) != 0;
+            __cpuid(regs, 1);
+            const bool osxsave = (regs[2] & (1 << 27)) != 0;
+            return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+    }
+
+    Level detectLevel()
+    {
+        static const Level level = []
+        {
+#ifdef NBA_SIMD_X86
+            return cpuHasAVX2() ? Level::AVX2 : Level::SSE2;
+#else
+            return Level::Scalar;
+#endif
+        }();
+        return level;
+    }
+
+    const char *levelName(Level level)
+    {
+        switch (level)
+        {
+        case Level::AVX2:
+            return "AVX2";
+        case Level::SSE2:
+            return "SSE2";
+        default:
+            return "scalar";
+        }
+    }
+
+    size_t findDelimiters(const char *data, size_t len, uint32_t *out, Level level)
+    {
+#ifdef NBA_SIMD_X86
+        if (level == Level::AVX2 && detectLevel() == Level::AVX2)
+            return findDelimitersAVX2(data, len, out);
+        if (level != Level::Scalar)
+            return findDelimitersSSE2(data, len, out);
+#else
+        (void)level;
+#endif
+        return findDelimitersScalar(data, len, out, 0, 0);
+    }
+
+    void andRangeMask(const int32_t *values, int count, int32_t lo, int32_t hi, uint64_t *mask,
+                      Level level)
+    {
+#ifdef NBA_SIMD_X86
+        if (level == Level::AVX2 && detectLevel() == Level::AVX2)
+            return andRangeMaskAVX2(values, count, lo, hi, mask);
+        if (level != Level::Scalar)
+            return andRangeMaskSSE2(values, count, lo, hi, mask);
+#else
+        (void)level;
+#endif
+        andRangeMaskScalar(values, 0, count, lo, hi, mask);
+    }
+
+    void andRangeMask(const float *values, int count, float lo, float hi, uint64_t *mask, Level level)
+    {
+#ifdef NBA_SIMD_X86
+        if (level == Level::AVX2 && detectLevel() == Level::AVX2)
+            return andRangeMaskAVX2(values, count, lo, hi, mask);
+        if (level != Level::Scalar)
+            return andRangeMaskSSE2(values, count, lo, hi, mask);
+#else
+        (void)level;
+#endif
+        andRangeMaskScalar(values, 0, count, lo, hi, mask);
+    }
+
+    namespace
+    {
+        template <bool Inclusive, typename T>
+        int countBelow(const T *keys, int n, T key, Level level)
+        {
+#ifdef NBA_SIMD_X86
+            if (level == Level::AVX2 && detectLevel() == Level::AVX2)
+                return countBelowAVX2<Inclusive>(keys, n, key);
+            if (level != Level::Scalar)
+                return countBelowSSE2<Inclusive>(keys, n, key);
+#else
+            (void)level;
+#endif
+            return countBelowScalar<Inclusive>(keys, 0, n, key);
+        }
+    }
+
+    int countLess(const int32_t *keys, int n, int32_t key, Level level)
+    {
+        return countBelow<false>(keys, n, key, level);
+    }
+
+    int countLessEqual(const int32_t *keys, int n, int32_t key, Level level)
+    {
+        return countBelow<true>(keys, n, key, level);
+    }
+
+    int countLess(const float *keys, int n, float key, Level level)
+    {
+        return countBelow<false>(keys, n, key, level);
+    }
+
+    int countLessEqual(const float *keys, int n, float key, Level level)
+    {
+        return countBelow<true>(keys, n, key, level);
+    }
+}
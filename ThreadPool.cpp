@@ -0,0 +1,131 @@
+#include "GameRecord.h"
+#include <algorithm>
+
+// =============================
+// ThreadPool
+// =============================
+ThreadPool::ThreadPool(unsigned thread_count)
+{
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < thread_count; ++i) shares.emplace_back(new Share());
+    threads.reserve(thread_count - 1);
+    for (unsigned i = 1; i < thread_count; ++i) threads.emplace_back(&ThreadPool::workerMain, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const RangeFn& fn)
+{
+    if (count == 0) return;
+    grain = std::max<size_t>(1, grain);
+    const unsigned n = size();
+    if (n == 1 || count <= grain) {
+        fn(0, 0, count);
+        return;
+    }
+
+    // Even contiguous shares; stealing evens out whatever the costs turn out to be
+    for (unsigned w = 0; w < n; ++w) {
+        Share& s = *shares[w];
+        std::lock_guard<std::mutex> lock(s.m);
+        s.next = count * w / n;
+        s.end = count * (w + 1) / n;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m);
+        job = &fn;
+        job_grain = grain;
+        running = n - 1;
+        ++generation;
+    }
+    wake.notify_all();
+
+    runShare(0);
+
+    std::unique_lock<std::mutex> lock(m);
+    done.wait(lock, [this] { return running == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerMain(unsigned worker)
+{
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runShare(worker);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (--running == 0) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runShare(unsigned worker)
+{
+    size_t begin, end;
+    for (;;) {
+        if (takeOwn(worker, begin, end)) (*job)(worker, begin, end);
+        else if (!steal(worker)) return;
+    }
+}
+
+bool ThreadPool::takeOwn(unsigned worker, size_t& begin, size_t& end)
+{
+    Share& s = *shares[worker];
+    std::lock_guard<std::mutex> lock(s.m);
+    if (s.next >= s.end) return false;
+    begin = s.next;
+    end = std::min(s.end, s.next + job_grain);
+    s.next = end;
+    return true;
+}
+
+// Moves the upper half of the fullest other share (all of it when no more
+// than one grain is left) into this worker's share
+bool ThreadPool::steal(unsigned worker)
+{
+    for (;;) {
+        unsigned victim = worker;
+        size_t most = 0;
+        for (unsigned w = 0; w < size(); ++w) {
+            if (w == worker) continue;
+            Share& s = *shares[w];
+            std::lock_guard<std::mutex> lock(s.m);
+            if (s.end - s.next > most) {
+                most = s.end - s.next;
+                victim = w;
+            }
+        }
+        if (most == 0) return false;
+
+        size_t begin, end;
+        {
+            Share& v = *shares[victim];
+            std::lock_guard<std::mutex> lock(v.m);
+            const size_t left = v.end - v.next;
+            if (left == 0) continue; // drained since we looked
+            begin = left <= job_grain ? v.next : v.next + left / 2;
+            end = v.end;
+            v.end = begin;
+        }
+        Share& own = *shares[worker];
+        std::lock_guard<std::mutex> lock(own.m);
+        own.next = begin;
+        own.end = end;
+        steals++;
+        return true;
+    }
+}
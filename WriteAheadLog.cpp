@@ -0,0 +1,235 @@
+#include "GameRecord.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// Log file: MAGIC | base (uint64), then one frame per group commit
+//   record_count (uint32) | checksum (uint32, FNV-1a of the records) | GameRecord[record_count]
+namespace
+{
+    const size_t LOG_HEADER_BYTES = sizeof(WriteAheadLog::MAGIC) + sizeof(uint64_t);
+    const size_t FRAME_HEADER_BYTES = 2 * sizeof(uint32_t);
+
+    uint32_t checksum(const char *data, size_t size)
+    {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= (uint8_t)data[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    bool syncStream(std::FILE *f)
+    {
+        if (std::fflush(f) != 0)
+            return false;
+#ifdef _WIN32
+        return _commit(_fileno(f)) == 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    bool truncateStream(std::FILE *f, uint64_t size)
+    {
+        if (std::fflush(f) != 0)
+            return false;
+#ifdef _WIN32
+        if (_chsize_s(_fileno(f), (long long)size) != 0)
+            return false;
+#else
+        if (ftruncate(fileno(f), (off_t)size) != 0)
+            return false;
+#endif
+        return std::fseek(f, 0, SEEK_END) == 0;
+    }
+
+    // 64-bit size (a long is 32 bits on Windows); leaves f at the start
+    bool streamSize(std::FILE *f, uint64_t &size)
+    {
+#ifdef _WIN32
+        if (_fseeki64(f, 0, SEEK_END) != 0)
+            return false;
+        const long long end = _ftelli64(f);
+#else
+        if (fseeko(f, 0, SEEK_END) != 0)
+            return false;
+        const off_t end = ftello(f);
+#endif
+        if (end < 0)
+            return false;
+        size = (uint64_t)end;
+        std::rewind(f);
+        return true;
+    }
+}
+
+// =============================
+// WriteAheadLog
+// =============================
+const char WriteAheadLog::MAGIC[8] = {'N', 'B', 'A', 'W', 'A', 'L', '0', '1'};
+
+WriteAheadLog::WriteAheadLog(size_t commit_batch)
+    : file_(nullptr), base_(0), records_(0), size_(0), commit_batch_(std::max<size_t>(1, commit_batch)),
+      frame_(FRAME_HEADER_BYTES, 0), pending_(0)
+{
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    close();
+}
+
+bool WriteAheadLog::open(const std::string &path, uint64_t base, std::vector<GameRecord> &recovered)
+{
+    close();
+    recovered.clear();
+    std::FILE *f = std::fopen(path.c_str(), "r+b");
+    if (!f)
+        f = std::fopen(path.c_str(), "w+b");
+    if (!f)
+        return false;
+    file_ = f;
+    records_ = 0;
+    pending_ = 0;
+    frame_.resize(FRAME_HEADER_BYTES);
+
+    uint64_t file_size = 0;
+    if (!streamSize(file_, file_size))
+    {
+        close();
+        return false;
+    }
+    // Shorter than a header: a reset was cut short, so the log is empty
+    if (file_size < LOG_HEADER_BYTES)
+        return reset(base);
+    char magic[sizeof(MAGIC)];
+    if (std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic) ||
+        std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        std::fread(&base_, 1, sizeof(base_), file_) != sizeof(base_))
+    {
+        close();
+        return false;
+    }
+
+    // Frames one at a time, up to the first one cut short or failing its checksum
+    uint64_t pos = LOG_HEADER_BYTES;
+    std::vector<char> payload;
+    while (file_size - pos >= FRAME_HEADER_BYTES)
+    {
+        uint32_t count, sum;
+        if (std::fread(&count, 1, sizeof(count), file_) != sizeof(count) ||
+            std::fread(&sum, 1, sizeof(sum), file_) != sizeof(sum))
+            break;
+        const uint64_t avail = file_size - pos - FRAME_HEADER_BYTES;
+        if (count == 0 || avail / sizeof(GameRecord) < count)
+            break;
+        payload.resize((size_t)count * sizeof(GameRecord));
+        if (std::fread(payload.data(), 1, payload.size(), file_) != payload.size() ||
+            checksum(payload.data(), payload.size()) != sum)
+            break;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            GameRecord record;
+            std::memcpy(&record, payload.data() + i * sizeof(GameRecord), sizeof(GameRecord));
+            recovered.push_back(record);
+        }
+        pos += FRAME_HEADER_BYTES + payload.size();
+    }
+    records_ = recovered.size();
+    size_ = pos;
+
+    // Drop a torn last frame so new frames follow the last whole one (the
+    // seek also switches the stream from reading to writing)
+    const bool positioned = std::fseek(file_, 0, SEEK_END) == 0 &&
+                            (pos == file_size || (truncateStream(file_, pos) && syncStream(file_)));
+    if (!positioned)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WriteAheadLog::close()
+{
+    if (!file_)
+        return;
+    commit();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool WriteAheadLog::append(const GameRecord &record)
+{
+    if (!file_)
+        return false;
+    const char *p = reinterpret_cast<const char *>(&record);
+    frame_.insert(frame_.end(), p, p + sizeof(GameRecord));
+    ++pending_;
+    return pending_ < commit_batch_ || commit();
+}
+
+bool WriteAheadLog::commit()
+{
+    if (!file_)
+        return false;
+    if (pending_ == 0)
+        return true;
+    const uint32_t count = (uint32_t)pending_;
+    const uint32_t sum = checksum(frame_.data() + FRAME_HEADER_BYTES, frame_.size() - FRAME_HEADER_BYTES);
+    std::memcpy(frame_.data(), &count, sizeof(count));
+    std::memcpy(frame_.data() + sizeof(count), &sum, sizeof(sum));
+
+    if (std::fwrite(frame_.data(), 1, frame_.size(), file_) != frame_.size() || !syncStream(file_))
+    {
+        // Cut off whatever part of the frame got out, so a later frame is not
+        // stranded behind it; the records stay pending
+        truncateStream(file_, size_);
+        return false;
+    }
+    size_ += frame_.size();
+    records_ += pending_;
+    stats_.records += pending_;
+    stats_.commits++;
+    stats_.bytes += frame_.size();
+    frame_.resize(FRAME_HEADER_BYTES);
+    pending_ = 0;
+    return true;
+}
+
+bool WriteAheadLog::reset(uint64_t base)
+{
+    if (!file_)
+        return false;
+    // Emptied before the new header goes in: a crash in between leaves an
+    // empty log, never old frames under the new base
+    if (!truncateStream(file_, 0) || !syncStream(file_))
+        return false;
+    if (std::fwrite(MAGIC, 1, sizeof(MAGIC), file_) != sizeof(MAGIC) ||
+        std::fwrite(&base, 1, sizeof(base), file_) != sizeof(base) || !syncStream(file_))
+        return false;
+    base_ = base;
+    records_ = 0;
+    size_ = LOG_HEADER_BYTES;
+    frame_.resize(FRAME_HEADER_BYTES);
+    pending_ = 0;
+    return true;
+}
+
+bool WriteAheadLog::syncFile(const std::string &path)
+{
+    std::FILE *f = std::fopen(path.c_str(), "r+b");
+    if (!f)
+        return false;
+    const bool ok = syncStream(f);
+    return std::fclose(f) == 0 && ok;
+}
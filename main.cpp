@@ -2,8 +2,12 @@
 #include <iostream>
 #include <iomanip>
 
-int main()
+int main(int argc, char **argv)
 {
+    // nba_db --bench <name> [data file]: run a micro-benchmark instead of the demo
+    if (argc >= 3 && std::string(argv[1]) == "--bench")
+        return Bench::run(argv[2], argc >= 4 ? argv[3] : "games.txt");
+
     std::cout << "NBA Games Database Management System" << std::endl;
     std::cout << "====================================" << std::endl;
 
@@ -40,41 +44,134 @@ int main()
     // Show index stats
     db.displayIndexStatistics();
 
-    // 4) Demo index searches (existing behavior)
+    // Persist indexes next to the heap file so later runs can skip the rebuild
+    if (!db.writeIndexesToDisk())
+    {
+        std::cerr << "Failed to write indexes to disk" << std::endl;
+        return 1;
+    }
+
+    // 4) Demo index searches (existing behavior); matches are fetched in block order
     std::cout << "\n4. Index-based searches:" << std::endl;
+    size_t blocks_read = 0;
 
     std::cout << "\nSearching for team ID 1610612744:" << std::endl;
-    auto team_results = db.searchByTeamId(1610612744);
-    std::cout << "Found " << team_results.size() << " records" << std::endl;
+    auto team_results = db.searchByTeamId(1610612744, &blocks_read);
+    std::cout << "Found " << team_results.size() << " records in " << blocks_read << " data blocks" << std::endl;
     for (size_t i = 0; i < std::min<size_t>(5, team_results.size()); i++)
     {
         team_results[i].display();
     }
 
     std::cout << "\nSearching for games with 110-120 points:" << std::endl;
-    auto points_results = db.searchByPointsRange(110, 120);
-    std::cout << "Found " << points_results.size() << " records" << std::endl;
+    auto points_results = db.searchByPointsRange(110, 120, &blocks_read);
+    std::cout << "Found " << points_results.size() << " records in " << blocks_read << " data blocks" << std::endl;
     for (size_t i = 0; i < std::min<size_t>(5, points_results.size()); i++)
     {
         points_results[i].display();
     }
 
     std::cout << "\nSearching for games with FG% between 0.5 and 0.6:" << std::endl;
-    auto fg_results = db.searchByFGPercentage(0.5f, 0.6f);
-    std::cout << "Found " << fg_results.size() << " records" << std::endl;
+    auto fg_results = db.searchByFGPercentage(0.5f, 0.6f, &blocks_read);
+    std::cout << "Found " << fg_results.size() << " records in " << blocks_read << " data blocks" << std::endl;
     for (size_t i = 0; i < std::min<size_t>(5, fg_results.size()); i++)
     {
         fg_results[i].display();
     }
 
     std::cout << "\nSearching for games with FT% between 0.9 and 1.0:" << std::endl;
-    auto ft_results = db.searchByFTPercentage(0.9f, 1.0f);
-    std::cout << "Found " << ft_results.size() << " records" << std::endl;
+    auto ft_results = db.searchByFTPercentage(0.9f, 1.0f, &blocks_read);
+    std::cout << "Found " << ft_results.size() << " records in " << blocks_read << " data blocks" << std::endl;
     for (size_t i = 0; i < std::min<size_t>(5, ft_results.size()); i++)
     {
         ft_results[i].display();
     }
 
+    std::cout << "\nSearching for games in the 2019-20 season (1/10/2019 - 31/10/2020):" << std::endl;
+    auto season_results = db.searchByDateRange("1/10/2019", "31/10/2020", &blocks_read);
+    std::cout << "Found " << season_results.size() << " records in " << blocks_read << " data blocks" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(5, season_results.size()); i++)
+    {
+        season_results[i].display();
+    }
+
+    std::cout << "\nSearching for team 1610612744 games in the 2019-20 season (team + date index):" << std::endl;
+    auto team_season_results = db.searchByTeamAndDateRange(1610612744, "1/10/2019", "31/10/2020", &blocks_read);
+    std::cout << "Found " << team_season_results.size() << " records in " << blocks_read << " data blocks" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(5, team_season_results.size()); i++)
+    {
+        team_season_results[i].display();
+    }
+
+    std::cout << "\nFirst 3 games with 110-120 points (streaming cursor, LIMIT 3):" << std::endl;
+    RecordCursor points_cursor = db.cursorByPointsRange(110, 120, 3);
+    GameRecord streamed;
+    while (points_cursor.next(streamed))
+    {
+        streamed.display();
+    }
+    std::cout << "Returned " << points_cursor.rowsReturned() << " records in " << points_cursor.blockReads()
+              << " data blocks" << std::endl;
+
+    std::cout << "\nAverage PTS for FT% > 0.9 (heap fetch vs covering index):" << std::endl;
+    for (bool index_only : {false, true})
+    {
+        const CoveredStats agg = db.aggregateFTAbove(0.9f, index_only);
+        std::cout << (index_only ? "  index-only: " : "  heap fetch: ") << agg.rows << " records, avg PTS "
+                  << std::fixed << std::setprecision(2) << agg.avgPts() << ", " << agg.wins << " home wins, "
+                  << "index nodes " << (agg.nInternal + agg.nLeaf + agg.nOverflow) << ", data blocks "
+                  << agg.nData << ", " << (agg.timeUs / 1000.0) << " ms" << std::endl;
+    }
+
+    // 5) Cold start: reopen heap + index files without rebuilding
+    std::cout << "\n5. Reopening database and indexes from disk..." << std::endl;
+    {
+        DatabaseFile db_cold("nba_games.db");
+        if (db_cold.openMapped() && db_cold.readIndexesFromDisk())
+        {
+            auto cold_results = db_cold.searchByFTPercentage(0.9f, 1.0f);
+            std::cout << "FT% between 0.9 and 1.0 after reload: "
+                      << cold_results.size() << " records" << std::endl;
+        }
+    }
+
+    // 6) Same queries through a bounded buffer pool (far fewer frames than blocks)
+    std::cout << "\n6. Index searches through a 32-frame buffer pool..." << std::endl;
+    {
+        std::unique_ptr<EvictionPolicy> policies[] = {
+            std::unique_ptr<EvictionPolicy>(new ClockPolicy()),
+            std::unique_ptr<EvictionPolicy>(new LRUKPolicy(2))};
+        for (auto &policy : policies)
+        {
+            DatabaseFile db_pool("nba_games.db");
+            if (!db_pool.openWithBufferPool(32, std::move(policy)) || !db_pool.readIndexesFromDisk())
+                continue;
+            db_pool.searchByFTPercentage(0.9f, 1.0f);
+            db_pool.searchByPointsRange(110, 120);
+            db_pool.displayBufferPoolStatistics();
+        }
+    }
+
+    // 7) Full scans, with and without per-block min/max (zone maps) to skip blocks
+    std::cout << "\n7. Full scans with zone maps:" << std::endl;
+    {
+        const std::pair<const char *, std::vector<ScanPredicate>> queries[] = {
+            {"2014-15 season (1/10/2014 - 30/6/2015)",
+             {ScanPredicate::between(GameColumn::Date, 20141001, 20150630)}},
+            {"FT% > 0.9", {ScanPredicate::greaterThan(GameColumn::FtPct, 0.9)}},
+            {"Points >= 150", {ScanPredicate::atLeast(GameColumn::Points, 150)}}};
+        for (const auto &q : queries)
+        {
+            size_t without = 0, with = 0;
+            db.setZoneMapsEnabled(false);
+            db.scan(q.second, Simd::detectLevel(), &without);
+            db.setZoneMapsEnabled(true);
+            const size_t matches = db.scan(q.second, Simd::detectLevel(), &with).size();
+            std::cout << q.first << ": " << matches << " records, data blocks read "
+                      << with << " of " << without << std::endl;
+        }
+    }
+
     // ==================== Task 3: Delete FT_PCT_home > 0.9 ====================
     // Run on fresh DB objects so Tasks 1/2 results remain unchanged.
     {
@@ -84,6 +181,12 @@ int main()
         DeletionStats sLin = db_linear.deleteByFTAboveLinear(0.9f);
         const double avgLin = sLin.nDeleted ? (sLin.sumFT / sLin.nDeleted) : 0.0;
 
+        // ---- Linear baseline over PAX blocks (FT% column is contiguous) ----
+        DatabaseFile db_pax("nba_games_pax.db");
+        db_pax.setBlockLayout(BlockLayout::Pax);
+        db_pax.loadFromTextFile("games.txt");
+        DeletionStats sPax = db_pax.deleteByFTAboveLinear(0.9f);
+
         // ---- Indexed path ----
         DatabaseFile db_indexed("nba_games_indexed.db");
         db_indexed.loadFromTextFile("games.txt");
@@ -99,6 +202,11 @@ int main()
         std::cout << "Average FT%: " << std::fixed << std::setprecision(3) << avgLin << "\n";
         std::cout << "Time: " << (sLin.timeUs / 1000.0) << " ms\n";
 
+        std::cout << "\n> Linear Deletion (PAX blocks)\n";
+        std::cout << "Data blocks accessed: " << sPax.nData << "\n";
+        std::cout << "Records deleted: " << sPax.nDeleted << "\n";
+        std::cout << "Time: " << (sPax.timeUs / 1000.0) << " ms\n";
+
         std::cout << "\n> Indexed Deletion\n";
         std::cout << "Index blocks accessed: "
                   << sIdx.nInternal << " internal, "
@@ -110,10 +218,11 @@ int main()
         std::cout << "Average FT%: " << std::fixed << std::setprecision(3) << avgIdx << "\n";
         std::cout << "Time: " << (sIdx.timeUs / 1000.0) << " ms\n";
 
-        // Rebuild FT index on the indexed copy (skip tombstoned) and show structure
-        db_indexed.rebuildFTIndexSkippingDeleted();
-        std::cout << "\n> FT Index structure after deletion\n";
+        // The deletion already removed those rows from every index in place
+        std::cout << "\n> Index structure after deletion (updated incrementally)\n";
         db_indexed.displayIndexStatistics();
+        std::cout << "FT% between 0.9 and 1.0 after deletion: "
+                  << db_indexed.searchByFTPercentage(0.9f, 1.0f).size() << " records\n";
     }
     // ================== end Task 3 additions ====================
 